@@ -0,0 +1,108 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___BENCH__BENCH_TOOLS_H
+#define DE__OSM3S___BENCH__BENCH_TOOLS_H
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../template_db/types.h"
+
+
+/* Each scenario prints one line of tab separated values:
+ *
+ *   scenario  cache  runs  min_ms  median_ms  max_ms  items
+ *
+ * cache is "warm" or "cold". items is the number of elements the scenario has processed
+ * per run. It must be equal between two compared commits, otherwise they measure different work.
+ * Lines starting with '#' are comments. */
+
+
+inline double bench_now_ms()
+{
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec*1000.0 + tv.tv_usec/1000.0;
+}
+
+
+// Asks the kernel to evict all files of the database from the page cache.
+// This needs no privileges but only evicts clean pages, hence it does not need a sync first.
+inline void drop_file_cache(const std::string& db_dir)
+{
+  DIR* dp = opendir(db_dir.c_str());
+  if (!dp)
+    return;
+  struct dirent* ep;
+  while ((ep = readdir(dp)))
+  {
+    int fd = open((db_dir + ep->d_name).c_str(), O_RDONLY);
+    if (fd < 0)
+      continue;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+  closedir(dp);
+}
+
+
+inline void print_bench_header()
+{
+  std::cout<<"# scenario\tcache\truns\tmin_ms\tmedian_ms\tmax_ms\titems\n";
+}
+
+
+/* Runs the scenario the given number of times. For cold runs the page cache of the database
+ * is dropped before each run, for warm runs the scenario is run once before the measurement. */
+template< typename Scenario >
+void run_bench(
+    const std::string& name, const std::string& db_dir, bool cold, uint runs, Scenario scenario)
+{
+  uint64 items = 0;
+  if (!cold)
+    items = scenario();
+
+  std::vector< double > times;
+  for (uint i = 0; i < runs; ++i)
+  {
+    if (cold)
+      drop_file_cache(db_dir);
+    double start = bench_now_ms();
+    items = scenario();
+    times.push_back(bench_now_ms() - start);
+  }
+  std::sort(times.begin(), times.end());
+  if (times.empty())
+    return;
+
+  std::cout<<name<<'\t'<<(cold ? "cold" : "warm")<<'\t'<<runs<<std::fixed<<std::setprecision(3)
+      <<'\t'<<times.front()<<'\t'<<times[times.size()/2]<<'\t'<<times.back()<<'\t'<<items<<'\n';
+  std::cout.flush();
+}
+
+
+#endif
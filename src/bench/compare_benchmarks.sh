@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+# Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+#
+# This file is part of Overpass_API.
+#
+# Overpass_API is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# Overpass_API is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with Overpass_API. If not, see <https://www.gnu.org/licenses/>.
+
+if [[ -z $2  ]]; then
+{
+  echo "Usage: $0 baseline_results new_results"
+  echo
+  echo "Prints per scenario the median times of both result files of run_benchmarks.sh"
+  echo "and their ratio. A ratio below 1 means that the new commit is faster."
+  exit 0
+};
+fi
+
+awk -F '\t' '
+    BEGIN { printf "# scenario\tcache\tbaseline_ms\tnew_ms\tratio\n"; }
+    FNR == 1 { ++file; }
+    /^#/ { next; }
+    file == 1 { median[$1"\t"$2] = $5; items[$1"\t"$2] = $7; next; }
+    {
+      key = $1"\t"$2;
+      if (!(key in median))
+        printf "%s\t-\t%s\t-\n", key, $5;
+      else
+      {
+        printf "%s\t%s\t%s\t%.3f", key, median[key], $5, (median[key] > 0 ? $5/median[key] : 0);
+        if (items[key] != $7)
+          printf "\titems differ: %s vs %s", items[key], $7;
+        printf "\n";
+      }
+    }' "$1" "$2"
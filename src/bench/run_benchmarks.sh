@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+
+# Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+#
+# This file is part of Overpass_API.
+#
+# Overpass_API is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# Overpass_API is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with Overpass_API. If not, see <https://www.gnu.org/licenses/>.
+
+if [[ -z $1  ]]; then
+{
+  echo "Usage: $0 data_size [runs] [result_file]"
+  echo
+  echo "An appropriate value for a fast run is 40, a meaningful value is 400."
+  echo "The results are written as tab separated values to result_file or stdout."
+  echo "Use compare_benchmarks.sh to compare the results of two commits."
+  exit 0
+};
+fi
+
+# The size of the test pattern, see run_testsuite_template_db.sh.
+# The database is kept between runs of the same size.
+DATA_SIZE="$1"
+RUNS="${2:-5}"
+RESULT="${3:-/dev/stdout}"
+BASEDIR="$(cd `dirname $0` && pwd)/.."
+DB_DIR="bench_db_$DATA_SIZE/"
+
+if [[ ! -s "$DB_DIR/nodes.map" ]]; then
+{
+  mkdir -p "$DB_DIR"
+  rm -f "$DB_DIR"*
+  $BASEDIR/test-bin/generate_test_file $DATA_SIZE "" 0 \
+      | $BASEDIR/bin/update_database --db-dir="$DB_DIR" --version=mock-up-init
+};
+fi
+
+{
+  echo "# data_size $DATA_SIZE"
+  $BASEDIR/bench/bench_template_db "$DB_DIR" $RUNS
+  $BASEDIR/bench/bench_statements "$DB_DIR" $RUNS | grep -v "^#"
+} >"$RESULT"
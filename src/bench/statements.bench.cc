@@ -0,0 +1,193 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+#include "../overpass_api/core/settings.h"
+#include "../overpass_api/frontend/output_handler_parser.h"
+#include "../overpass_api/statements/around.h"
+#include "../overpass_api/statements/bbox_query.h"
+#include "../overpass_api/statements/polygon_query.h"
+#include "../overpass_api/statements/print.h"
+#include "../overpass_api/statements/query.h"
+#include "../overpass_api/statements/testing_tools.h"
+#include "../template_db/block_backend.h"
+#include "bench_tools.h"
+
+
+struct Null_Buffer : std::streambuf
+{
+  virtual int overflow(int c) { return c; }
+};
+
+
+// Keeps the output of print statements out of the benchmark results
+struct Discard_Cout
+{
+  Discard_Cout() : saved(std::cout.rdbuf(&null_buffer)) {}
+  ~Discard_Cout() { std::cout.rdbuf(saved); }
+
+private:
+  Null_Buffer null_buffer;
+  std::streambuf* saved;
+};
+
+
+template< typename Index, typename Object >
+uint64 count_elems(const std::map< Index, std::vector< Object > >& elems)
+{
+  uint64 count = 0;
+  for (typename std::map< Index, std::vector< Object > >::const_iterator it = elems.begin();
+      it != elems.end(); ++it)
+    count += it->second.size();
+  return count;
+}
+
+
+uint64 count_set(Resource_Manager& rman, const std::string& set_name)
+{
+  const Set* set = rman.get_set(set_name);
+  if (!set)
+    return 0;
+  return count_elems(set->nodes) + count_elems(set->ways) + count_elems(set->relations);
+}
+
+
+uint64 around_calc_ranges(Around_Statement& around, Resource_Manager& rman)
+{
+  uint64 count = 0;
+  for (uint i = 0; i < 1000; ++i)
+  {
+    Ranges< Uint32_Index > ranges = around.calc_ranges(Set(), rman);
+    for (Ranges< Uint32_Index >::Iterator it = ranges.begin(); it != ranges.end(); ++it)
+      ++count;
+  }
+  return count;
+}
+
+
+uint64 around_is_inside(const Around_Statement& around, double lat, double lon)
+{
+  uint64 count = 0;
+  for (uint i = 0; i < 500; ++i)
+  {
+    for (uint j = 0; j < 500; ++j)
+      count += around.is_inside(lat - 1.0 + i/250., lon - 1.5 + j/166.7);
+  }
+  return count;
+}
+
+
+uint64 polygon_query(Parsed_Query& global_settings, Resource_Manager& rman, const std::string& bounds)
+{
+  Polygon_Query_Statement(0, Attr()("bounds", bounds).kvs(), global_settings).execute(rman);
+  return count_set(rman, "_");
+}
+
+
+uint64 tag_query(
+    Parsed_Query& global_settings, Resource_Manager& rman, const std::map< std::string, std::string >& tag_attributes)
+{
+  Statement_Container cont(global_settings);
+  Query_Statement stmt(0, Attr()("type", "node")("into", "tagged").kvs(), global_settings);
+  cont.create_stmt< Has_Kv_Statement >(tag_attributes, &stmt);
+  stmt.execute(rman);
+  return count_set(rman, "tagged");
+}
+
+
+uint64 print_xml(Parsed_Query& global_settings, Resource_Manager& rman, const std::string& mode)
+{
+  Discard_Cout discard;
+  Print_Statement(0, Attr()("from", "all")("mode", mode).kvs(), global_settings).execute(rman);
+  return count_set(rman, "all");
+}
+
+
+int main(int argc, char* args[])
+{
+  if (argc < 3)
+  {
+    std::cout<<"Usage: "<<args[0]<<" db_dir runs [scenario]\n";
+    return 0;
+  }
+  std::string db_dir = args[1];
+  uint runs = atoi(args[2]);
+  std::string only = argc > 3 ? args[3] : "";
+
+  // The generated test data spreads its nodes over lat 30 to 50 and lon -120 to -60
+  std::string lat = "40.0";
+  std::string lon = "-90.0";
+  std::string bounds = "30.0 -120.0 50.0 -120.0 50.0 -90.0 30.0 -60.0";
+
+  try
+  {
+    Nonsynced_Transaction transaction(false, false, db_dir, "");
+    Parsed_Query global_settings;
+    global_settings.set_output_handler(Output_Handler_Parser::get_format_parser("xml"), 0, 0);
+    Resource_Manager rman(transaction, &global_settings);
+
+    Around_Statement around(0, Attr()("radius", "100000")("lat", lat)("lon", lon).kvs(),
+        global_settings);
+    around.calc_lat_lons(Set(), around, rman);
+
+    Bbox_Query_Statement(0, Attr()("into", "all")("s", "30")("n", "50")("w", "-120")("e", "-60").kvs(),
+        global_settings).execute(rman);
+
+    print_bench_header();
+    for (int cold = 0; cold < 2; ++cold)
+    {
+      // calc_ranges and is_inside are pure computations, hence a cold run makes no difference
+      if (!cold && (only == "" || only == "around_calc_ranges"))
+        run_bench("around_calc_ranges", db_dir, cold, runs,
+            [&]() { return around_calc_ranges(around, rman); });
+      if (!cold && (only == "" || only == "around_is_inside"))
+        run_bench("around_is_inside", db_dir, cold, runs,
+            [&]() { return around_is_inside(around, atof(lat.c_str()), atof(lon.c_str())); });
+      if (only == "" || only == "polygon_query")
+        run_bench("polygon_query", db_dir, cold, runs,
+            [&]() { return polygon_query(global_settings, rman, bounds); });
+      if (only == "" || only == "query_key_only")
+        run_bench("query_key_only", db_dir, cold, runs,
+            [&]() { return tag_query(global_settings, rman, Attr()("k", "node_key_5").kvs()); });
+      if (only == "" || only == "query_key_regex")
+        run_bench("query_key_regex", db_dir, cold, runs,
+            [&]() { return tag_query(global_settings, rman,
+                Attr()("k", "node_key_5")("regv", "^node_value_[0-9]+$").kvs()); });
+      if (only == "" || only == "print_xml_ids")
+        run_bench("print_xml_ids", db_dir, cold, runs,
+            [&]() { return print_xml(global_settings, rman, "ids_only"); });
+      if (only == "" || only == "print_xml_skeleton")
+        run_bench("print_xml_skeleton", db_dir, cold, runs,
+            [&]() { return print_xml(global_settings, rman, "skeleton"); });
+      if (only == "" || only == "print_xml_body")
+        run_bench("print_xml_body", db_dir, cold, runs,
+            [&]() { return print_xml(global_settings, rman, "body"); });
+    }
+  }
+  catch (File_Error e)
+  {
+    std::cerr<<"File error caught: "<<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../overpass_api/core/settings.h"
+#include "../overpass_api/core/type_node.h"
+#include "../overpass_api/core/type_way.h"
+#include "../template_db/block_backend.h"
+#include "../template_db/file_blocks.h"
+#include "../template_db/transaction.h"
+#include "bench_tools.h"
+
+
+uint64 read_all_blocks(Transaction& transaction, const File_Properties* file_prop)
+{
+  File_Blocks< Uint32_Index, std::vector< Uint32_Index >::const_iterator >
+      file_blocks(transaction.data_index(file_prop));
+  uint64 count = 0;
+  for (auto it = file_blocks.flat_begin(); !(it == file_blocks.flat_end()); ++it)
+  {
+    file_blocks.read_block(it);
+    ++count;
+  }
+  return count;
+}
+
+
+template< typename Index, typename Skeleton >
+uint64 iterate_flat(Transaction& transaction, const File_Properties* file_prop)
+{
+  Block_Backend< Index, Skeleton > db(transaction.data_index(file_prop));
+  uint64 count = 0;
+  for (auto it = db.flat_begin(); !(it == db.flat_end()); ++it)
+    ++count;
+  return count;
+}
+
+
+template< typename Index, typename Skeleton >
+uint64 iterate_discrete(
+    Transaction& transaction, const File_Properties* file_prop, const std::vector< Index >& req)
+{
+  Block_Backend< Index, Skeleton > db(transaction.data_index(file_prop));
+  uint64 count = 0;
+  for (auto it = db.discrete_begin(req.begin(), req.end()); !(it == db.discrete_end()); ++it)
+    ++count;
+  return count;
+}
+
+
+template< typename Index, typename Skeleton >
+uint64 iterate_range(
+    Transaction& transaction, const File_Properties* file_prop, const Ranges< Index >& ranges)
+{
+  Block_Backend< Index, Skeleton > db(transaction.data_index(file_prop));
+  uint64 count = 0;
+  for (auto it = db.range_begin(ranges); !(it == db.range_end()); ++it)
+    ++count;
+  return count;
+}
+
+
+// Every stride-th index of the file, such that the requests hit a spread subset of the blocks
+template< typename Index, typename Skeleton >
+std::vector< Index > sample_indices(Transaction& transaction, const File_Properties* file_prop, uint stride)
+{
+  std::set< Index > all;
+  Block_Backend< Index, Skeleton > db(transaction.data_index(file_prop));
+  for (auto it = db.flat_begin(); !(it == db.flat_end()); ++it)
+    all.insert(it.index());
+
+  std::vector< Index > result;
+  uint i = 0;
+  for (typename std::set< Index >::const_iterator it = all.begin(); it != all.end(); ++it)
+  {
+    if (i++ % stride == 0)
+      result.push_back(*it);
+  }
+  return result;
+}
+
+
+int main(int argc, char* args[])
+{
+  if (argc < 3)
+  {
+    std::cout<<"Usage: "<<args[0]<<" db_dir runs [scenario]\n";
+    return 0;
+  }
+  std::string db_dir = args[1];
+  uint runs = atoi(args[2]);
+  std::string only = argc > 3 ? args[3] : "";
+
+  try
+  {
+    Nonsynced_Transaction transaction(false, false, db_dir, "");
+
+    std::vector< Uint32_Index > node_req = sample_indices< Uint32_Index, Node_Skeleton >(
+        transaction, osm_base_settings().NODES, 16);
+    std::vector< Uint31_Index > way_idxs = sample_indices< Uint31_Index, Way_Skeleton >(
+        transaction, osm_base_settings().WAYS, 16);
+    Ranges< Uint31_Index > way_ranges;
+    for (std::vector< Uint31_Index >::const_iterator it = way_idxs.begin(); it != way_idxs.end(); ++it)
+      way_ranges.push_back(*it, Uint31_Index(it->val() + 1));
+    way_ranges.sort();
+
+    print_bench_header();
+    for (int cold = 0; cold < 2; ++cold)
+    {
+      if (only == "" || only == "file_blocks_read")
+        run_bench("file_blocks_read", db_dir, cold, runs,
+            [&]() { return read_all_blocks(transaction, osm_base_settings().NODES); });
+      if (only == "" || only == "block_backend_flat")
+        run_bench("block_backend_flat", db_dir, cold, runs,
+            [&]() { return iterate_flat< Uint32_Index, Node_Skeleton >(
+                transaction, osm_base_settings().NODES); });
+      if (only == "" || only == "block_backend_discrete")
+        run_bench("block_backend_discrete", db_dir, cold, runs,
+            [&]() { return iterate_discrete< Uint32_Index, Node_Skeleton >(
+                transaction, osm_base_settings().NODES, node_req); });
+      if (only == "" || only == "block_backend_range")
+        run_bench("block_backend_range", db_dir, cold, runs,
+            [&]() { return iterate_range< Uint31_Index, Way_Skeleton >(
+                transaction, osm_base_settings().WAYS, way_ranges); });
+    }
+  }
+  catch (File_Error e)
+  {
+    std::cerr<<"File error caught: "<<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+    return 1;
+  }
+
+  return 0;
+}
@@ -19,7 +19,7 @@
 
 if [[ -z $3  ]]; then
 {
-  echo "Usage: $0 replicate_dir start_id --meta=(attic|yes|no)"
+  echo "Usage: $0 replicate_dir start_id --meta=(attic|yes|no) [--augmented-diffs]"
   exit 0
 }; fi
 
@@ -52,6 +52,17 @@ else
   exit 0
 }; fi
 
+AUGMENTED_DIFFS=
+if [[ $4 == "--augmented-diffs" ]]; then
+{
+  if [[ $META != "--keep-attic" ]]; then
+  {
+    echo "Augmented diffs need --meta=attic"
+    exit 0
+  }; fi
+  AUGMENTED_DIFFS=yes
+}; fi
+
 
 get_replicate_filename()
 {
@@ -126,6 +137,42 @@ update_state()
 };
 
 
+# Materializes every augmented diff whose minute is completely covered by the applied data.
+# The CGI then only streams the stored file instead of running the adiff query per request.
+produce_augmented_diffs()
+{
+  ADIFF_DIR="$DB_DIR/augmented_diffs"
+  UNTIL_SECS=$(date --utc --date="${DATA_VERSION//\\/}" '+%s')
+  if [[ -s $ADIFF_DIR/newest ]]; then
+  {
+    CURRENT_DIFF=$(($(cat $ADIFF_DIR/newest) + 1))
+  }; else
+  {
+    CURRENT_DIFF=$(( ( $UNTIL_SECS - 1347432960 ) / 60 ))
+  }; fi
+
+  while [[ $(($CURRENT_DIFF * 60 + 1347432960)) -le $UNTIL_SECS ]]; do
+  {
+    EPOCHSECS=$(($CURRENT_DIFF * 60 + 1347432900))
+    SINCE=`date --utc --date="@$EPOCHSECS" '+%FT%H:%M:%SZ'`
+    UNTIL=`date --utc --date="@$(($EPOCHSECS + 60))" '+%FT%H:%M:%SZ'`
+
+    echo '[adiff:"'$SINCE'","'$UNTIL'"];(node(changed:"'$SINCE'","'$UNTIL'");way(changed:"'$SINCE'","'$UNTIL'");rel(changed:"'$SINCE'","'$UNTIL'"););out meta geom;' \
+        | ./osm3s_query | gzip >"$ADIFF_DIR/_$CURRENT_DIFF.osc.gz"
+    if [[ ${PIPESTATUS[1]} -ne 0 ]]; then
+    {
+      echo "$(date -u '+%F %T'): augmented diff $CURRENT_DIFF failed" >>$DB_DIR/apply_osc_to_db.log
+      rm -f "$ADIFF_DIR/_$CURRENT_DIFF.osc.gz"
+      return
+    }; fi
+    mv "$ADIFF_DIR/_$CURRENT_DIFF.osc.gz" "$ADIFF_DIR/$CURRENT_DIFF.osc.gz"
+    echo $CURRENT_DIFF >"$ADIFF_DIR/newest"
+
+    CURRENT_DIFF=$(($CURRENT_DIFF + 1))
+  }; done
+};
+
+
 shutdown()
 {
   if [[ $CHILD_PID -ge 1 ]]; then
@@ -171,6 +218,11 @@ while [[ true ]]; do
     apply_minute_diffs $TEMP_DIR
     echo "$TARGET" >$DB_DIR/replicate_id
 
+    if [[ -n $AUGMENTED_DIFFS ]]; then
+    {
+      produce_augmented_diffs
+    }; fi
+
     echo "$(date -u '+%F %T'): update complete" $TARGET >>$DB_DIR/apply_osc_to_db.log
   };
   else
@@ -20,6 +20,9 @@
 #define DE__OSM3S___OVERPASS_API__CORE__BASIC_TYPES_H
 
 
+#include "../../template_db/types.h"
+
+#include <algorithm>
 #include <vector>
 
 
@@ -174,7 +177,7 @@ struct Uint64
   static bool equal(void* lhs, void* rhs) { return *(uint64*)lhs == *(uint64*)rhs; }
   bool less(void* rhs) const { return value < *(uint64*)rhs; }
   bool leq(void* rhs) const { return value <= *(uint64*)rhs; }
-  bool equal(void* rhs) const { return value == *(uint32*)rhs; }
+  bool equal(void* rhs) const { return value == *(uint64*)rhs; }
 
   uint32 size_of() const { return 8; }
   static constexpr uint32 const_size() { return 8; }
@@ -284,6 +287,46 @@ struct Attic : public Element_Skeleton
 };
 
 
+/* The block summary of attic elements is the latest month any of its elements has been
+ * valid until, plus one to keep zero free for "unknown". The timestamp encodes year and month
+ * in the bits above bit 22. */
+template< typename Element_Skeleton >
+struct Block_Summary< Attic< Element_Skeleton > >
+{
+  static const bool enabled = true;
+
+  static uint32 of(const void* data)
+  {
+    return ((*(uint64*)((uint8*)data + Element_Skeleton::size_of((void*)data)) & 0xffffffffffull)>>22) + 1;
+  }
+
+  static uint32 merge(uint32 lhs, uint32 rhs) { return std::max(lhs, rhs); }
+};
+
+
+/* The current skeletons carry Bloom filters of their ids per block such that lookups by id
+ * can skip the blocks that cannot contain any of the requested ids. */
+template< typename Skeleton >
+struct Skeleton_Id_Bloom
+{
+  static const bool enabled = true;
+  static uint64 id_of(const void* data) { return Skeleton::get_id((void*)data).val(); }
+};
+
+
+/* Attic elements are only relevant for a timestamp if they have been valid until after
+ * that timestamp. Hence blocks that only contain elements with an earlier month can be skipped. */
+struct Attic_Timestamp_Filter : Block_Filter
+{
+  Attic_Timestamp_Filter(uint64 timestamp) : min_summary((timestamp>>22) + 1) {}
+
+  virtual bool may_contain(uint32 summary) const { return min_summary <= summary; }
+
+private:
+  uint32 min_summary;
+};
+
+
 template< typename Attic >
 struct Delta_Comparator
 {
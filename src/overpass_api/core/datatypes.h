@@ -620,6 +620,51 @@ struct Change_Entry
 };
 
 
+/* Entry of the reverse membership files. It is stored under the id of the member
+ * and refers to a way or relation that has this member. */
+struct Parent_Entry
+{
+  typedef Uint32_Index Id_Type;
+
+  Parent_Entry(const Uint31_Index& idx_, const Id_Type& id_) : idx(idx_), id(id_) {}
+
+  Uint31_Index idx;
+  Id_Type id;
+
+  Parent_Entry(void* data) : idx((uint8*)data), id((uint8*)data + 4) {}
+
+  uint32 size_of() const
+  {
+    return 8;
+  }
+
+  static uint32 size_of(void* data)
+  {
+    return 8;
+  }
+
+  void to_data(void* data) const
+  {
+    idx.to_data((uint8*)data);
+    id.to_data((uint8*)data + 4);
+  }
+
+  bool operator<(const Parent_Entry& rhs) const
+  {
+    if (id < rhs.id)
+      return true;
+    if (rhs.id < id)
+      return false;
+    return (idx < rhs.idx);
+  }
+
+  bool operator==(const Parent_Entry& rhs) const
+  {
+    return (idx == rhs.idx && id == rhs.id);
+  }
+};
+
+
 struct Timestamp
 {
   Timestamp(uint64 timestamp_) : timestamp(timestamp_) {}
@@ -160,6 +160,11 @@ Osm_Base_Settings::Osm_Base_Settings()
   RELATION_FREQUENT_TAGS(new OSM_File_Properties< String_Index >
       ("relation_frequent_tags", 512*1024, 0)),
 
+  NODE_WAYS(new OSM_File_Properties< Uint64 >("node_ways", 128*1024, 0)),
+  NODE_RELATIONS(new OSM_File_Properties< Uint64 >("node_relations", 128*1024, 0)),
+  WAY_RELATIONS(new OSM_File_Properties< Uint64 >("way_relations", 128*1024, 0)),
+  RELATION_RELATIONS(new OSM_File_Properties< Uint64 >("relation_relations", 128*1024, 0)),
+
   shared_name(basic_settings().shared_name_base + "_osm_base"),
   max_num_processes(20),
   purge_timeout(900),
@@ -169,7 +174,8 @@ Osm_Base_Settings::Osm_Base_Settings()
   bin_idxs_ = {
       NODES, NODE_TAGS_LOCAL, NODE_TAGS_GLOBAL, NODE_KEYS, NODE_FREQUENT_TAGS,
       WAYS, WAY_TAGS_LOCAL, WAY_TAGS_GLOBAL, WAY_KEYS, WAY_FREQUENT_TAGS,
-      RELATIONS, RELATION_ROLES, RELATION_TAGS_LOCAL, RELATION_TAGS_GLOBAL, RELATION_KEYS, RELATION_FREQUENT_TAGS };
+      RELATIONS, RELATION_ROLES, RELATION_TAGS_LOCAL, RELATION_TAGS_GLOBAL, RELATION_KEYS, RELATION_FREQUENT_TAGS,
+      NODE_WAYS, NODE_RELATIONS, WAY_RELATIONS, RELATION_RELATIONS };
   map_idxs_ = { NODES, WAYS, RELATIONS };
 }
 
@@ -68,6 +68,10 @@ struct Osm_Base_Settings
   File_Properties* RELATION_TAGS_GLOBAL_756;
   File_Properties* RELATION_KEYS;
   File_Properties* RELATION_FREQUENT_TAGS;
+  File_Properties* NODE_WAYS;
+  File_Properties* NODE_RELATIONS;
+  File_Properties* WAY_RELATIONS;
+  File_Properties* RELATION_RELATIONS;
 
   std::string shared_name;
   uint max_num_processes;
@@ -139,4 +139,8 @@ struct Node_Skeleton
 };
 
 
+template< >
+struct Block_Id_Bloom< Node_Skeleton > : Skeleton_Id_Bloom< Node_Skeleton > {};
+
+
 #endif
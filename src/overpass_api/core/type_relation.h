@@ -189,6 +189,10 @@ struct Relation_Skeleton
 };
 
 
+template< >
+struct Block_Id_Bloom< Relation_Skeleton > : Skeleton_Id_Bloom< Relation_Skeleton > {};
+
+
 struct Relation_Delta
 {
   typedef Relation_Skeleton::Id_Type Id_Type;
@@ -239,6 +239,46 @@ struct Tag_Index_Local
 };
 
 
+/* The block summary of local tags is a bitmap of the keys in the block: each key sets
+ * one of the bits 0 to 30 by its hash. Bit 31 is always set to keep zero free for "unknown". */
+template< >
+struct Block_Index_Summary< Tag_Index_Local >
+{
+  static const bool enabled = true;
+
+  static uint32 of(const void* data)
+  { return 0x80000000u | key_bit((const char*)data + 7, *(const uint16*)data); }
+
+  static uint32 merge(uint32 lhs, uint32 rhs) { return lhs | rhs; }
+
+  static uint32 key_bit(const char* key, uint32 length)
+  {
+    uint32 hash = 2166136261u;
+    for (uint32 i = 0; i < length; ++i)
+      hash = (hash ^ (uint8)key[i]) * 16777619u;
+    return 1u<<(hash % 31);
+  }
+};
+
+
+/* Skips the local tag blocks that contain none of the given keys. Only valid for scans
+ * where entries with other keys do not matter, and only for files without object summary. */
+struct Tag_Key_Filter : Block_Filter
+{
+  template< typename Iterator >
+  Tag_Key_Filter(Iterator begin, Iterator end) : mask(0)
+  {
+    for (; begin != end; ++begin)
+      mask |= Block_Index_Summary< Tag_Index_Local >::key_bit(begin->first.data(), begin->first.size());
+  }
+
+  virtual bool may_contain(uint32 summary) const { return summary & mask; }
+
+private:
+  uint32 mask;
+};
+
+
 inline const std::string& void_tag_value()
 {
   static std::string void_value = " ";
@@ -429,6 +469,12 @@ struct Tag_Index_Global_KVI
 
   Tag_Index_Global_KVI(const Tag_Index_Local& tag_idx) : key(tag_idx.key), value(tag_idx.value), idx(0) {}
 
+  // Views on key and value of a raw index without constructing strings
+  static uint16 key_size(const void* data) { return *(const uint16*)data; }
+  static const char* key_ptr(const void* data) { return (const char*)data + 8; }
+  static uint16 value_size(const void* data) { return *((const uint16*)data + 1); }
+  static const char* value_ptr(const void* data) { return (const char*)data + 8 + key_size(data); }
+
   Tag_Index_Global_KVI(const std::string& key_, const std::string& value_) : key(key_), value(value_), idx(0) {}
   Tag_Index_Global_KVI(const std::string& key_, const std::string& value_, uint32 idx_)
     : key(key_), value(value_), idx(idx_) {}
@@ -156,6 +156,10 @@ struct Way_Skeleton
 };
 
 
+template< >
+struct Block_Id_Bloom< Way_Skeleton > : Skeleton_Id_Bloom< Way_Skeleton > {};
+
+
 struct Way_Delta
 {
   typedef Way_Skeleton::Id_Type Id_Type;
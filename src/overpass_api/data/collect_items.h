@@ -231,10 +231,7 @@ bool collect_items_by_timestamp(const Statement* stmt, Resource_Manager& rman,
     {
       count = 0;
       if (stmt)
-      {
-        rman.health_check(*stmt, 0, eval_map(result));
-        rman.health_check(*stmt, 0, eval_map(attic_result));
-      }
+        rman.health_check(*stmt);
     }
     Index index =
         (attic_begin == attic_end ||
@@ -280,10 +277,7 @@ bool collect_items_by_timestamp(const Statement* stmt, Resource_Manager& rman,
     {
       count = 0;
       if (stmt)
-      {
-        rman.health_check(*stmt, 0, eval_map(result));
-        rman.health_check(*stmt, 0, eval_map(attic_result));
-      }
+        rman.health_check(*stmt);
     }
     Index index =
         (attic_begin == attic_end ||
@@ -327,10 +321,7 @@ bool collect_items_by_timestamp(const Statement* stmt, Resource_Manager& rman,
     {
       count = 0;
       if (stmt)
-      {
-        rman.health_check(*stmt, 0, eval_map(result));
-        rman.health_check(*stmt, 0, eval_map(attic_result));
-      }
+        rman.health_check(*stmt);
     }
     Index index =
         (attic_begin == attic_end ||
@@ -360,20 +351,21 @@ template < class Index, class Object, class Container, class Predicate >
 void collect_items_discrete(const Statement* stmt, Resource_Manager& rman,
 		   File_Properties& file_properties,
 		   const Container& req, const Predicate& predicate,
-		   std::map< Index, std::vector< Object > >& result)
+		   std::map< Index, std::vector< Object > >& result, const Block_Filter* filter = 0)
 {
   uint32 count = 0;
   Block_Backend< Index, Object, typename Container::const_iterator > db
       (rman.get_transaction()->data_index(&file_properties));
   for (typename Block_Backend< Index, Object, typename Container
       ::const_iterator >::Discrete_Iterator
-      it(db.discrete_begin(req.begin(), req.end())); !(it == db.discrete_end()); ++it)
+      it(filter ? db.discrete_begin(req.begin(), req.end(), *filter) : db.discrete_begin(req.begin(), req.end()));
+      !(it == db.discrete_end()); ++it)
   {
     if (++count >= 256*1024)
     {
       count = 0;
       if (stmt)
-        rman.health_check(*stmt, 0, eval_map(result));
+        rman.health_check(*stmt);
     }
     if (predicate.match(it.handle()))
       result[it.index()].push_back(it.object());
@@ -409,9 +401,10 @@ void collect_items_discrete_by_timestamp(const Statement* stmt, Resource_Manager
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
   Block_Backend< Index, Attic< typename Object::Delta >, typename Container::const_iterator > attic_db
       (rman.get_transaction()->data_index(attic_skeleton_file_properties< Object >()));
+  Attic_Timestamp_Filter attic_filter(rman.get_desired_timestamp());
   collect_items_by_timestamp(stmt, rman,
       current_db.discrete_begin(req.begin(), req.end()), current_db.discrete_end(),
-      attic_db.discrete_begin(req.begin(), req.end()), attic_db.discrete_end(),
+      attic_db.discrete_begin(req.begin(), req.end(), attic_filter), attic_db.discrete_end(),
       predicate, (Index*)0, rman.get_desired_timestamp(), result, attic_result);
 }
 
@@ -426,9 +419,10 @@ void collect_items_discrete_by_timestamp(const Statement* stmt, Resource_Manager
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
   Block_Backend< Index, Attic< typename Object::Delta >, typename Container::const_iterator > attic_db
       (rman.get_transaction()->data_index(attic_skeleton_file_properties< Object >()));
+  Attic_Timestamp_Filter attic_filter(timestamp);
   collect_items_by_timestamp(stmt, rman,
       current_db.discrete_begin(req.begin(), req.end()), current_db.discrete_end(),
-      attic_db.discrete_begin(req.begin(), req.end()), attic_db.discrete_end(),
+      attic_db.discrete_begin(req.begin(), req.end(), attic_filter), attic_db.discrete_end(),
       predicate, (Index*)0, timestamp, result, attic_result);
 }
 
@@ -436,15 +430,17 @@ void collect_items_discrete_by_timestamp(const Statement* stmt, Resource_Manager
 template < class Index, class Object, class Predicate >
 bool collect_items_range(const Statement* stmt, Resource_Manager& rman,
     const Ranges< Index >& ranges, const Predicate& predicate, Index& cur_idx,
-    std::map< Index, std::vector< Object > >& result)
+    std::map< Index, std::vector< Object > >& result, const Block_Filter* filter = 0)
 {
   uint32 count = 0;
   bool too_much_data = false;
+  uint64 space_at_start = rman.used_space();
   Block_Backend< Index, Object > db
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
 
   Ranges< Index > shortened = ranges.skip_start(cur_idx);
-  for (auto it = db.range_begin(shortened); !(it == db.range_end()); ++it)
+  for (auto it = filter ? db.range_begin(shortened, *filter) : db.range_begin(shortened);
+      !(it == db.range_end()); ++it)
   {
     if (too_much_data && !(cur_idx == it.index()))
     {
@@ -454,7 +450,8 @@ bool collect_items_range(const Statement* stmt, Resource_Manager& rman,
     if (++count >= 256*1024 && stmt)
     {
       count = 0;
-      too_much_data = rman.health_check(*stmt, 0, eval_map(result));
+      uint64 space_now = rman.used_space();
+      too_much_data = rman.health_check(*stmt, 0, space_now > space_at_start ? space_now - space_at_start : 0);
       cur_idx = it.index();
     }
     if (predicate.match(it.handle()))
@@ -494,9 +491,10 @@ bool collect_items_range_by_timestamp(const Statement* stmt, Resource_Manager& r
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
   Block_Backend< Index, Attic< typename Object::Delta > > attic_db
       (rman.get_transaction()->data_index(attic_skeleton_file_properties< Object >()));
+  Attic_Timestamp_Filter attic_filter(rman.get_desired_timestamp());
   return collect_items_by_timestamp(stmt, rman,
       current_db.range_begin(shortened), current_db.range_end(),
-      attic_db.range_begin(shortened), attic_db.range_end(),
+      attic_db.range_begin(shortened, attic_filter), attic_db.range_end(),
       predicate, &cur_idx, rman.get_desired_timestamp(), result, attic_result);
 }
 
@@ -513,9 +511,10 @@ void collect_items_range_by_timestamp(const Statement* stmt, Resource_Manager& r
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
   Block_Backend< Index, Attic< typename Object::Delta > > attic_db
       (rman.get_transaction()->data_index(attic_skeleton_file_properties< Object >()));
+  Attic_Timestamp_Filter attic_filter(rman.get_desired_timestamp());
   collect_items_by_timestamp(stmt, rman,
       current_db.range_begin(ranges), current_db.range_end(),
-      attic_db.range_begin(ranges), attic_db.range_end(),
+      attic_db.range_begin(ranges, attic_filter), attic_db.range_end(),
       predicate, (Index*)0, rman.get_desired_timestamp(), result, attic_result);
 }
 
@@ -534,7 +533,7 @@ void collect_items_flat(const Statement& stmt, Resource_Manager& rman,
     if (++count >= 256*1024)
     {
       count = 0;
-      rman.health_check(stmt, 0, eval_map(result));
+      rman.health_check(stmt);
     }
     if (predicate.match(it.handle()))
       result[it.index()].push_back(it.object());
@@ -552,9 +551,10 @@ void collect_items_flat_by_timestamp(const Statement& stmt, Resource_Manager& rm
       (rman.get_transaction()->data_index(current_skeleton_file_properties< Object >()));
   Block_Backend< Index, Attic< typename Object::Delta > > attic_db
       (rman.get_transaction()->data_index(attic_skeleton_file_properties< Object >()));
+  Attic_Timestamp_Filter attic_filter(rman.get_desired_timestamp());
   collect_items_by_timestamp(&stmt, rman,
       current_db.flat_begin(), current_db.flat_end(),
-      attic_db.flat_begin(), attic_db.flat_end(),
+      attic_db.flat_begin(attic_filter), attic_db.flat_end(),
       predicate, (Index*)0, rman.get_desired_timestamp(), result, attic_result);
 }
 
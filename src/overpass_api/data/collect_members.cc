@@ -1083,6 +1083,27 @@ void keep_matching_skeletons
 }
 
 
+bool collect_parent_indices(const Statement& stmt, Resource_Manager& rman, const File_Properties& file_prop,
+    const std::vector< Uint64 >& member_ids, std::set< Uint31_Index >& req)
+{
+  if (!file_exists(rman.get_transaction()->get_db_dir() + file_prop.get_file_name_trunk()
+      + file_prop.get_data_suffix() + file_prop.get_index_suffix()))
+    return false;
+
+  std::vector< Uint64 > ids = member_ids;
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  Block_Backend< Uint64, Parent_Entry, std::vector< Uint64 >::const_iterator > db
+      (rman.get_transaction()->data_index(&file_prop));
+  for (Block_Backend< Uint64, Parent_Entry, std::vector< Uint64 >::const_iterator >::Discrete_Iterator
+      it(db.discrete_begin(ids.begin(), ids.end())); !(it == db.discrete_end()); ++it)
+    req.insert(it.object().idx);
+  rman.health_check(stmt);
+
+  return true;
+}
+
+
 Timeless< Uint31_Index, Way_Skeleton > collect_ways(
     const Statement& query, Resource_Manager& rman,
     const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& rels,
@@ -1108,7 +1129,9 @@ Timeless< Uint31_Index, Way_Skeleton > collect_ways
   {
     std::vector< Uint64 > children_ids = extract_ids(nodes);
     rman.health_check(stmt);
-    std::set< Uint31_Index > req = extract_parent_indices(nodes);
+    std::set< Uint31_Index > req;
+    if (!collect_parent_indices(stmt, rman, *osm_base_settings().NODE_WAYS, children_ids, req))
+      req = extract_parent_indices(nodes);
     rman.health_check(stmt);
 
     if (!invert_ids)
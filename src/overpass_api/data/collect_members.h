@@ -288,12 +288,12 @@ bool get_elements_by_id_from_db_generic(
     std::map< Index, std::vector< Attic< Object > > >& attic_elements,
     const Predicate& pred,
     const Ranges< Index >& ranges, Index& cur_idx,
-    const Statement& query, Resource_Manager& rman)
+    const Statement& query, Resource_Manager& rman, const Block_Filter* filter = 0)
 {
   if (ranges.empty())
     return false;
   return rman.get_desired_timestamp() == NOW
-      ? collect_items_range(&query, rman, ranges, pred, cur_idx, elements)
+      ? collect_items_range(&query, rman, ranges, pred, cur_idx, elements, filter)
       : collect_items_range_by_timestamp(&query, rman, ranges, pred, cur_idx, elements, attic_elements);
 }
 
@@ -315,6 +315,12 @@ bool Collect_Items< Index, Object >::get_chunk(
           elements, attic_elements, Not_Predicate< Object, Id_Predicate< Object > >(Id_Predicate< Object >(*ids)),
           ranges, min_idx, *query, *rman);
   }
+  if (ids->size() <= Block_Id_Filter::MAX_IDS)
+  {
+    Block_Id_Filter filter(ids->begin(), ids->end());
+    return get_elements_by_id_from_db_generic(
+        elements, attic_elements, Id_Predicate< Object >(*ids), ranges, min_idx, *query, *rman, &filter);
+  }
   return get_elements_by_id_from_db_generic(
       elements, attic_elements, Id_Predicate< Object >(*ids), ranges, min_idx, *query, *rman);
 }
@@ -1162,6 +1168,13 @@ std::set< Uint31_Index > extract_parent_indices(const std::map< TIndex, std::vec
 }
 
 
+/* Looks up in the reverse membership file file_prop the indices of the ways or relations
+ * that have one of member_ids as member. Returns false if the database has no such file.
+ * Then the candidate indices must be derived from the indices of the members. */
+bool collect_parent_indices(const Statement& stmt, Resource_Manager& rman, const File_Properties& file_prop,
+    const std::vector< Uint64 >& member_ids, std::set< Uint31_Index >& req);
+
+
 Timeless< Uint31_Index, Way_Skeleton > collect_ways(
     const Statement& query, Resource_Manager& rman,
     const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& rels,
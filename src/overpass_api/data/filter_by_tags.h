@@ -30,6 +30,63 @@ Ranges< Tag_Index_Global > get_kv_req(const std::string& key, const std::string&
 }
 
 
+/* Frequent key-value pairs are split in the global tag index by the upper 8, 16, or 24 bits of
+ * the objects' indices, all other pairs are stored under index 0. Thus a spatial restriction
+ * becomes a few slices per split level, and the objects outside these slices lie outside the ranges.
+ * The global tag objects keep only bits 8 to 30 of the index, hence the mask on the bounds. */
+template< typename Index >
+Ranges< Tag_Index_Global > get_kv_req(
+    const std::string& key, const std::string& value, const Ranges< Index >& ranges)
+{
+  const uint MAX_SLICES_PER_LEVEL = 1024;
+
+  Ranges< Tag_Index_Global > result;
+  result.push_back(Tag_Index_Global{ key, value, 0 }, Tag_Index_Global{ key, value, 1 });
+
+  for (uint level = 8; level <= 24; level += 8)
+  {
+    uint32 mask = (0xffffffff<<(32-level)) & 0x7fffff00;
+    std::vector< std::pair< uint32, uint32 > > slices;
+    for (typename Ranges< Index >::Iterator it = ranges.begin(); it != ranges.end(); ++it)
+    {
+      uint32 lower = it.lower_bound().val();
+      uint32 upper = it.upper_bound().val() - 1;
+      if (upper < lower)
+        continue;
+      // Dropping bit 31 keeps each half monotone but folds the upper half onto the lower one
+      if (lower < 0x80000000 && upper >= 0x80000000)
+      {
+        slices.push_back(std::make_pair(lower & mask, (0x7fffffff & mask) + 1));
+        lower = 0x80000000;
+      }
+      slices.push_back(std::make_pair(lower & mask, (upper & mask) + 1));
+    }
+    if (slices.empty())
+      continue;
+
+    std::sort(slices.begin(), slices.end());
+    std::vector< std::pair< uint32, uint32 > > merged(1, slices.front());
+    for (std::vector< std::pair< uint32, uint32 > >::const_iterator it = slices.begin() + 1;
+        it != slices.end(); ++it)
+    {
+      if (merged.back().second < it->first)
+        merged.push_back(*it);
+      else
+        merged.back().second = std::max(merged.back().second, it->second);
+    }
+    if (merged.size() > MAX_SLICES_PER_LEVEL)
+      merged = std::vector< std::pair< uint32, uint32 > >(
+          1, std::make_pair(merged.front().first, merged.back().second));
+
+    for (std::vector< std::pair< uint32, uint32 > >::const_iterator it = merged.begin(); it != merged.end(); ++it)
+      result.push_back(Tag_Index_Global{ key, value, it->first }, Tag_Index_Global{ key, value, it->second });
+  }
+  result.sort();
+
+  return result;
+}
+
+
 Ranges< Tag_Index_Global > get_k_req(const std::string& key)
 {
   return Ranges< Tag_Index_Global >(
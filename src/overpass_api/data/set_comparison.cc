@@ -1061,6 +1061,7 @@ Diff_Set Set_Comparison::compare_to_lhs(Resource_Manager& rman, const Statement&
     const Set& input_set, double south, double north, double west, double east, bool add_deletion_information)
 {
   result.clear();
+  lhs_spill.merge_into(lhs_set_);
 
   uint64 rhs_timestamp = rman.get_desired_timestamp();
   rman.set_desired_timestamp(lhs_timestamp_);
@@ -1211,6 +1212,7 @@ Diff_Set Set_Comparison::compare_to_lhs(Resource_Manager& rman, const Statement&
     const Set& input_set, Evaluator* evaluator, bool add_deletion_information)
 {
   result.clear();
+  lhs_spill.merge_into(lhs_set_);
 
   uint64 rhs_timestamp = rman.get_desired_timestamp();
   rman.set_desired_timestamp(lhs_timestamp_);
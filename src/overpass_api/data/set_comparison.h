@@ -25,6 +25,7 @@
 #include "geometry_from_quad_coords.h"
 #include "meta_collector.h"
 #include "relation_geometry_store.h"
+#include "spilled_set.h"
 #include "tag_store.h"
 #include "way_geometry_store.h"
 
@@ -60,7 +61,11 @@ class Set_Comparison
 {
 public:
   Set_Comparison(Transaction& transaction, const Set& lhs_set, uint64 lhs_timestamp)
-      : final_target(0), lhs_set_(lhs_set), lhs_timestamp_(lhs_timestamp) {}
+      : final_target(0), lhs_set_(lhs_set), lhs_timestamp_(lhs_timestamp), lhs_spill(transaction.get_db_dir()) {}
+
+  // The lhs set is not needed before the rhs set has been computed. Thus it can wait on disk.
+  void spill_lhs_on_pressure(Resource_Manager& rman, const Statement& stmt)
+  { lhs_spill.spill_on_pressure(rman, stmt, lhs_set_); }
 
   Diff_Set compare_to_lhs(Resource_Manager& rman, const Statement& stmt, const Set& input_set,
       double south, double north, double west, double east, bool add_deletion_information);
@@ -181,6 +186,7 @@ private:
 
   Set lhs_set_;
   uint64 lhs_timestamp_;
+  Spilled_Set lhs_spill;
 
   Diff_Set result;
 };
@@ -0,0 +1,141 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__DATA__SHARED_RANGES_CACHE_H
+#define DE__OSM3S___OVERPASS_API__DATA__SHARED_RANGES_CACHE_H
+
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../../template_db/ranges.h"
+#include "../core/basic_types.h"
+
+
+/* Keeps the ranges of filters that appear identically in several sibling statements,
+ * e.g. the same area filter in the node, way, and relation branch of a union.
+ * Every entry remembers the sets its filter reads. A statement that overwrites one
+ * of these sets must invalidate them. */
+class Shared_Ranges_Cache
+{
+public:
+  bool get(const std::string& key, Ranges< Uint32_Index >& ranges) const
+  { return get_entry(node_ranges, key, ranges); }
+  bool get(const std::string& key, Ranges< Uint31_Index >& ranges) const
+  { return get_entry(parent_ranges, key, ranges); }
+  bool get(const std::string& key, std::set< Uint31_Index >& area_blocks) const
+  { return get_entry(area_blocks_reqs, key, area_blocks); }
+
+  void put(const std::string& key, const std::vector< std::string >& inputs,
+      const Ranges< Uint32_Index >& ranges)
+  { put_entry(node_ranges, key, inputs, ranges); }
+  void put(const std::string& key, const std::vector< std::string >& inputs,
+      const Ranges< Uint31_Index >& ranges)
+  { put_entry(parent_ranges, key, inputs, ranges); }
+  void put(const std::string& key, const std::vector< std::string >& inputs,
+      const std::set< Uint31_Index >& area_blocks)
+  { put_entry(area_blocks_reqs, key, inputs, area_blocks); }
+
+  void invalidate(const std::vector< std::string >& set_names);
+  void clear();
+
+private:
+  template< typename Value >
+  struct Entry
+  {
+    std::vector< std::string > inputs;
+    Value value;
+  };
+
+  template< typename Value >
+  static bool get_entry(const std::map< std::string, Entry< Value > >& entries,
+      const std::string& key, Value& value);
+  template< typename Value >
+  static void put_entry(std::map< std::string, Entry< Value > >& entries,
+      const std::string& key, const std::vector< std::string >& inputs, const Value& value);
+  template< typename Value >
+  static void invalidate_entries(std::map< std::string, Entry< Value > >& entries,
+      const std::vector< std::string >& set_names);
+
+  std::map< std::string, Entry< Ranges< Uint32_Index > > > node_ranges;
+  std::map< std::string, Entry< Ranges< Uint31_Index > > > parent_ranges;
+  std::map< std::string, Entry< std::set< Uint31_Index > > > area_blocks_reqs;
+};
+
+
+template< typename Value >
+bool Shared_Ranges_Cache::get_entry(const std::map< std::string, Entry< Value > >& entries,
+    const std::string& key, Value& value)
+{
+  typename std::map< std::string, Entry< Value > >::const_iterator it = entries.find(key);
+  if (it == entries.end())
+    return false;
+  value = it->second.value;
+  return true;
+}
+
+
+template< typename Value >
+void Shared_Ranges_Cache::put_entry(std::map< std::string, Entry< Value > >& entries,
+    const std::string& key, const std::vector< std::string >& inputs, const Value& value)
+{
+  Entry< Value >& entry = entries[key];
+  entry.inputs = inputs;
+  entry.value = value;
+}
+
+
+template< typename Value >
+void Shared_Ranges_Cache::invalidate_entries(std::map< std::string, Entry< Value > >& entries,
+    const std::vector< std::string >& set_names)
+{
+  typename std::map< std::string, Entry< Value > >::iterator it = entries.begin();
+  while (it != entries.end())
+  {
+    bool stale = false;
+    for (std::vector< std::string >::const_iterator it2 = it->second.inputs.begin();
+        it2 != it->second.inputs.end() && !stale; ++it2)
+      stale = (std::find(set_names.begin(), set_names.end(), *it2) != set_names.end());
+    if (stale)
+      entries.erase(it++);
+    else
+      ++it;
+  }
+}
+
+
+inline void Shared_Ranges_Cache::invalidate(const std::vector< std::string >& set_names)
+{
+  invalidate_entries(node_ranges, set_names);
+  invalidate_entries(parent_ranges, set_names);
+  invalidate_entries(area_blocks_reqs, set_names);
+}
+
+
+inline void Shared_Ranges_Cache::clear()
+{
+  node_ranges.clear();
+  parent_ranges.clear();
+  area_blocks_reqs.clear();
+}
+
+
+#endif
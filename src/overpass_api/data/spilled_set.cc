@@ -0,0 +1,280 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "abstract_processing.h"
+#include "spilled_set.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace
+{
+  // The size of the chunks in which runs are written and read
+  const uint64 SPILL_BUFFER_SIZE = 4*1024*1024;
+
+
+  // Each block is stored as its byte size, the index, the number of objects and the objects
+  template< typename Index, typename Object >
+  uint64 block_size(const Index& idx, const std::vector< Object >& objects)
+  {
+    uint64 size = 8 + idx.size_of();
+    for (typename std::vector< Object >::const_iterator it = objects.begin(); it != objects.end(); ++it)
+      size += it->size_of();
+    return size;
+  }
+
+
+  template< typename Index, typename Object >
+  uint64 spill_size(const std::map< Index, std::vector< Object > >& items)
+  {
+    uint64 size = 0;
+    for (typename std::map< Index, std::vector< Object > >::const_iterator it = items.begin();
+        it != items.end(); ++it)
+      size += block_size(it->first, it->second);
+    return size;
+  }
+}
+
+
+Spilled_Set::~Spilled_Set()
+{
+  if (fd >= 0)
+    close(fd);
+}
+
+
+bool Spilled_Set::spill_on_pressure(Resource_Manager& rman, const Statement& stmt, Set& set)
+{
+  // Declaring all used space as releasable tells whether the query has used half of its space.
+  // Only then it is worth to walk the set to get its size.
+  if (!rman.health_check(stmt, 0, rman.used_space()))
+    return false;
+
+  uint64 size = spill_size(set.nodes) + spill_size(set.attic_nodes)
+      + spill_size(set.ways) + spill_size(set.attic_ways)
+      + spill_size(set.relations) + spill_size(set.attic_relations);
+
+  if (size == 0 || !rman.health_check(stmt, 0, size))
+    return false;
+
+  return spill(set);
+}
+
+
+bool Spilled_Set::spill(Set& set)
+{
+  if (!open_file())
+    return false;
+
+  uint64 run_start = file_size;
+  Run run;
+  if (!write_section(set.nodes, run.nodes) || !write_section(set.attic_nodes, run.attic_nodes)
+      || !write_section(set.ways, run.ways) || !write_section(set.attic_ways, run.attic_ways)
+      || !write_section(set.relations, run.relations)
+      || !write_section(set.attic_relations, run.attic_relations))
+  {
+    file_size = run_start;
+    if (ftruncate64(fd, file_size) < 0)
+      throw File_Error(errno, "spilled set", "Spilled_Set::spill::ftruncate64");
+    return false;
+  }
+  runs.push_back(run);
+
+  std::map< Uint32_Index, std::vector< Node_Skeleton > >().swap(set.nodes);
+  std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >().swap(set.attic_nodes);
+  std::map< Uint31_Index, std::vector< Way_Skeleton > >().swap(set.ways);
+  std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >().swap(set.attic_ways);
+  std::map< Uint31_Index, std::vector< Relation_Skeleton > >().swap(set.relations);
+  std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >().swap(set.attic_relations);
+
+  return true;
+}
+
+
+void Spilled_Set::merge_into(Set& target, const Set* subtrahend)
+{
+  if (runs.empty())
+    return;
+
+  for (std::vector< Run >::const_iterator it = runs.begin(); it != runs.end(); ++it)
+  {
+    merge_section(it->nodes, target.nodes, subtrahend ? &subtrahend->nodes : 0);
+    merge_section(it->attic_nodes, target.attic_nodes, subtrahend ? &subtrahend->attic_nodes : 0);
+    merge_section(it->ways, target.ways, subtrahend ? &subtrahend->ways : 0);
+    merge_section(it->attic_ways, target.attic_ways, subtrahend ? &subtrahend->attic_ways : 0);
+    merge_section(it->relations, target.relations, subtrahend ? &subtrahend->relations : 0);
+    merge_section(it->attic_relations, target.attic_relations,
+        subtrahend ? &subtrahend->attic_relations : 0);
+  }
+
+  runs.clear();
+  file_size = 0;
+  if (fd >= 0 && ftruncate64(fd, 0) < 0)
+    throw File_Error(errno, "spilled set", "Spilled_Set::merge_into::ftruncate64");
+}
+
+
+// The file is unlinked right away, such that it vanishes with the process also if the process is killed
+bool Spilled_Set::open_file()
+{
+  if (fd >= 0)
+    return true;
+
+  std::string name = db_dir + "spilled_set.XXXXXX";
+  std::vector< char > name_buf(name.begin(), name.end());
+  name_buf.push_back(0);
+
+  fd = mkstemp(&name_buf[0]);
+  if (fd < 0)
+    return false;
+  unlink(&name_buf[0]);
+
+  return true;
+}
+
+
+bool Spilled_Set::write_at_end(const std::vector< uint8 >& buf)
+{
+  uint64 written = 0;
+  while (written < buf.size())
+  {
+    ssize_t result = pwrite64(fd, &buf[written], buf.size() - written, file_size + written);
+    if (result <= 0)
+      return false;
+    written += result;
+  }
+  file_size += written;
+  return true;
+}
+
+
+void Spilled_Set::read_at(std::vector< uint8 >& buf, uint64 offset, uint64 size) const
+{
+  buf.resize(size);
+  uint64 read = 0;
+  while (read < size)
+  {
+    ssize_t result = pread64(fd, &buf[read], size - read, offset + read);
+    if (result <= 0)
+      throw File_Error(errno, "spilled set", "Spilled_Set::read_at");
+    read += result;
+  }
+}
+
+
+template< typename Index, typename Object >
+bool Spilled_Set::write_section(const std::map< Index, std::vector< Object > >& items, Section& section)
+{
+  section.offset = file_size;
+
+  std::vector< uint8 > buf;
+  for (typename std::map< Index, std::vector< Object > >::const_iterator it = items.begin();
+      it != items.end(); ++it)
+  {
+    if (it->second.empty())
+      continue;
+
+    uint64 pos = buf.size();
+    uint64 size = block_size(it->first, it->second);
+    buf.resize(pos + size);
+
+    uint8* ptr = &buf[pos];
+    *(uint32*)ptr = size;
+    it->first.to_data(ptr + 4);
+    ptr += 4 + it->first.size_of();
+    *(uint32*)ptr = it->second.size();
+    ptr += 4;
+    for (typename std::vector< Object >::const_iterator it_obj = it->second.begin();
+        it_obj != it->second.end(); ++it_obj)
+    {
+      it_obj->to_data(ptr);
+      ptr += it_obj->size_of();
+    }
+
+    if (buf.size() >= SPILL_BUFFER_SIZE)
+    {
+      if (!write_at_end(buf))
+        return false;
+      buf.clear();
+    }
+  }
+  if (!write_at_end(buf))
+    return false;
+
+  section.size = file_size - section.offset;
+  return true;
+}
+
+
+template< typename Index, typename Object >
+void Spilled_Set::merge_section(const Section& section, std::map< Index, std::vector< Object > >& target,
+    const std::map< Index, std::vector< Object > >* subtrahend) const
+{
+  std::vector< uint8 > buf;
+  uint64 pos = 0;
+  while (pos < section.size)
+  {
+    read_at(buf, section.offset + pos, std::min(SPILL_BUFFER_SIZE, section.size - pos));
+    uint32 first_size = *(uint32*)&buf[0];
+    if (first_size > buf.size())
+      read_at(buf, section.offset + pos, first_size);
+
+    std::map< Index, std::vector< Object > > chunk;
+    uint64 used = 0;
+    while (used + 4 <= buf.size() && used + *(uint32*)&buf[used] <= buf.size())
+    {
+      uint8* ptr = &buf[used];
+      used += *(uint32*)ptr;
+
+      Index idx(ptr + 4);
+      ptr += 4 + idx.size_of();
+      uint32 count = *(uint32*)ptr;
+      ptr += 4;
+
+      std::vector< Object >& objects = chunk[idx];
+      objects.reserve(count);
+      for (uint32 i = 0; i < count; ++i)
+      {
+        objects.push_back(Object(ptr));
+        ptr += objects.back().size_of();
+      }
+
+      if (subtrahend)
+      {
+        typename std::map< Index, std::vector< Object > >::const_iterator
+            it_sub = subtrahend->find(idx);
+        if (it_sub != subtrahend->end())
+        {
+          std::vector< Object > remaining;
+          std::sort(objects.begin(), objects.end());
+          std::set_difference(objects.begin(), objects.end(), it_sub->second.begin(), it_sub->second.end(),
+              back_inserter(remaining));
+          objects.swap(remaining);
+        }
+      }
+    }
+    pos += used;
+
+    indexed_set_union(target, chunk);
+  }
+}
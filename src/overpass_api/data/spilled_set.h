@@ -0,0 +1,96 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__DATA__SPILLED_SET_H
+#define DE__OSM3S___OVERPASS_API__DATA__SPILLED_SET_H
+
+
+#include "../core/datatypes.h"
+#include "../dispatch/resource_manager.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/* Keeps the elements of a Set in a temporary file in the database directory
+ * while the memory is needed for other work.
+ * Every spill appends one run per element type. The runs are sorted by index like the set itself.
+ * They are merged back block by block, such that only the result must fit into memory.
+ * Areas and derived elements are never spilled. */
+class Spilled_Set
+{
+  Spilled_Set(const Spilled_Set&);
+  Spilled_Set& operator=(const Spilled_Set&);
+
+public:
+  Spilled_Set(const std::string& db_dir_) : db_dir(db_dir_), fd(-1), file_size(0) {}
+  ~Spilled_Set();
+
+  // Spills the set if it takes more than half of the space that is left to the query.
+  // Returns true if the set has been spilled. Without a space limit nothing is ever spilled.
+  bool spill_on_pressure(Resource_Manager& rman, const Statement& stmt, Set& set);
+
+  // Moves the elements of the set to disk. If the temporary file cannot be written
+  // then the set stays untouched and false is returned.
+  bool spill(Set& set);
+
+  bool empty() const { return runs.empty(); }
+
+  // Adds all spilled elements to target and discards the runs.
+  // Elements that are contained in subtrahend are left out.
+  void merge_into(Set& target, const Set* subtrahend = 0);
+
+private:
+  struct Section
+  {
+    Section() : offset(0), size(0) {}
+
+    uint64 offset;
+    uint64 size;
+  };
+
+  struct Run
+  {
+    Section nodes;
+    Section attic_nodes;
+    Section ways;
+    Section attic_ways;
+    Section relations;
+    Section attic_relations;
+  };
+
+  bool open_file();
+  bool write_at_end(const std::vector< uint8 >& buf);
+  void read_at(std::vector< uint8 >& buf, uint64 offset, uint64 size) const;
+
+  template< typename Index, typename Object >
+  bool write_section(const std::map< Index, std::vector< Object > >& items, Section& section);
+
+  template< typename Index, typename Object >
+  void merge_section(const Section& section, std::map< Index, std::vector< Object > >& target,
+      const std::map< Index, std::vector< Object > >* subtrahend) const;
+
+  std::string db_dir;
+  int fd;
+  uint64 file_size;
+  std::vector< Run > runs;
+};
+
+
+#endif
@@ -20,6 +20,8 @@
 #define DE__OSM3S___OVERPASS_API__DATA__TAGS_GLOBAL_READER_H
 
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -283,6 +285,99 @@ public:
 };
 
 
+/* Evaluates the conditions on key and value once per distinct key-value pair of the global tag index.
+ * Consecutive indices mostly share key and value and differ only in idx,
+ * thus the raw index is compared in place to the last pair and the cached result is reused. */
+template< typename Key_Regex, typename Val_Regex >
+class Tag_Match_Cache
+{
+public:
+  Tag_Match_Cache(const Key_Regex& key_regex_, const Val_Regex& val_regex_)
+      : key_regex(key_regex_), val_regex(val_regex_), valid(false), last_result(false) {}
+
+  bool matches(const void* index_data)
+  {
+    uint16 key_size = Tag_Index_Global::key_size(index_data);
+    uint16 value_size = Tag_Index_Global::value_size(index_data);
+    if (valid && key_size == last_key.size() && value_size == last_value.size()
+        && !memcmp(Tag_Index_Global::key_ptr(index_data), last_key.data(), key_size)
+        && !memcmp(Tag_Index_Global::value_ptr(index_data), last_value.data(), value_size))
+      return last_result;
+
+    last_key.assign(Tag_Index_Global::key_ptr(index_data), key_size);
+    last_value.assign(Tag_Index_Global::value_ptr(index_data), value_size);
+    last_result = key_regex.matches(last_key) && last_value != void_tag_value() && val_regex.matches(last_value);
+    valid = true;
+    return last_result;
+  }
+
+private:
+  const Key_Regex& key_regex;
+  const Val_Regex& val_regex;
+  bool valid;
+  bool last_result;
+  std::string last_key;
+  std::string last_value;
+};
+
+
+template< typename Id_Type >
+const Id_Type& id_of_entry(const Id_Type& entry) { return entry; }
+
+template< typename Id_Type >
+const Id_Type& id_of_entry(const std::pair< Id_Type, Uint31_Index >& entry) { return entry.first; }
+
+
+/* Tests membership in a list of entries sorted by id.
+ * The objects of a single key-value pair come sorted by id, thus the probes mostly ascend.
+ * Then a probe gallops forward from the position of the previous probe,
+ * such that intersecting a short with a long list does not pay a full binary search per entry.
+ * A descending probe falls back to a binary search over the whole list. */
+template< typename Id_Type, typename Entry >
+class Galloping_Probe
+{
+public:
+  Galloping_Probe(const std::vector< Entry >& entries_) : entries(entries_), pos(0) {}
+
+  bool contains(const Id_Type& id)
+  {
+    typename std::vector< Entry >::size_type size = entries.size();
+    if (pos > 0 && !(id_of_entry< Id_Type >(entries[pos-1]) < id))
+      pos = lower_bound(0, size, id);
+    else
+    {
+      typename std::vector< Entry >::size_type lo = pos;
+      typename std::vector< Entry >::size_type step = 1;
+      while (lo + step < size && id_of_entry< Id_Type >(entries[lo + step - 1]) < id)
+      {
+        lo += step;
+        step *= 2;
+      }
+      pos = lower_bound(lo, std::min(lo + step, size), id);
+    }
+    return pos < size && !(id < id_of_entry< Id_Type >(entries[pos]));
+  }
+
+private:
+  const std::vector< Entry >& entries;
+  typename std::vector< Entry >::size_type pos;
+
+  typename std::vector< Entry >::size_type lower_bound(
+      typename std::vector< Entry >::size_type lo, typename std::vector< Entry >::size_type hi, const Id_Type& id)
+  {
+    while (lo < hi)
+    {
+      typename std::vector< Entry >::size_type mid = lo + (hi - lo)/2;
+      if (id_of_entry< Id_Type >(entries[mid]) < id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+};
+
+
 template< typename Id_Type, typename Iterator, typename Key_Regex, typename Val_Regex >
 void filter_id_list(
     std::vector< std::pair< Id_Type, Uint31_Index > >& new_ids, bool& filtered,
@@ -291,12 +386,12 @@ void filter_id_list(
 {
   std::vector< std::pair< Id_Type, Uint31_Index > > old_ids;
   old_ids.swap(new_ids);
+  Galloping_Probe< Id_Type, std::pair< Id_Type, Uint31_Index > > probe(old_ids);
+  Tag_Match_Cache< Key_Regex, Val_Regex > match_cache(key_regex, val_regex);
 
   for (Iterator it = begin; !(it == end); ++it)
   {
-    if (key_regex.matches(it.index().key) && it.index().value != void_tag_value()
-        && val_regex.matches(it.index().value) && (!filtered ||
-	std::binary_search(old_ids.begin(), old_ids.end(), std::make_pair(it.object().id, Uint31_Index(0u)))))
+    if (match_cache.matches(it.index_data()) && (!filtered || probe.contains(it.object().id)))
       new_ids.push_back(std::make_pair(it.object().id, it.object().idx));
 
     if (!filtered && limit_size && new_ids.size() == 1024*1024)
@@ -320,12 +415,12 @@ void filter_id_list(
 {
   std::vector< Id_Type > old_ids;
   old_ids.swap(new_ids);
+  Galloping_Probe< Id_Type, Id_Type > probe(old_ids);
+  Tag_Match_Cache< Key_Regex, Val_Regex > match_cache(key_regex, val_regex);
 
   for (Iterator it = begin; !(it == end); ++it)
   {
-    if (key_regex.matches(it.index().key) && it.index().value != void_tag_value()
-        && val_regex.matches(it.index().value) &&
-	(!filtered || std::binary_search(old_ids.begin(), old_ids.end(), it.object())))
+    if (match_cache.matches(it.index_data()) && (!filtered || probe.contains(it.object())))
       new_ids.push_back(it.object());
   }
 
@@ -343,11 +438,11 @@ void filter_id_list(
 {
   std::vector< std::pair< Id_Type, Uint31_Index > > old_ids;
   old_ids.swap(new_ids);
+  Galloping_Probe< Id_Type, std::pair< Id_Type, Uint31_Index > > probe(old_ids);
 
   for (typename Container::const_iterator it = container.begin(); it != container.end(); ++it)
   {
-    if (!filtered ||
-	std::binary_search(old_ids.begin(), old_ids.end(), std::make_pair(it->first, Uint31_Index(0u))))
+    if (!filtered || probe.contains(it->first))
       new_ids.push_back(std::make_pair(it->first, it->second.second));
   }
 
@@ -361,7 +456,46 @@ void filter_id_list(
 class Statement;
 
 
-template< typename Skeleton, typename Id_Type >
+inline Ranges< Tag_Index_Global > tag_req_of(const std::pair< std::string, std::string >& key_value)
+{
+  return get_kv_req(key_value.first, key_value.second);
+}
+
+inline Ranges< Tag_Index_Global > tag_req_of(const std::string& key)
+{
+  return get_k_req(key);
+}
+
+
+/* Orders the conditions by the size of their part of the global tag index, smallest first.
+ * Then filter_id_list materializes the shortest list of ids and only probes the others against it.
+ * The sizes come from the block index alone, and each estimate stops once it exceeds the smallest so far. */
+template< typename Condition, typename Tags_Db >
+std::vector< Condition > order_by_index_size(const std::vector< Condition >& conditions, Tags_Db& tags_db)
+{
+  if (conditions.size() < 2)
+    return conditions;
+
+  std::vector< std::pair< uint64, uint > > sizes;
+  uint64 smallest = std::numeric_limits< uint64 >::max();
+  for (uint i = 0; i < conditions.size(); ++i)
+  {
+    uint64 size = tags_db.range_size(tag_req_of(conditions[i]), smallest);
+    smallest = std::min(smallest, size + 1);
+    sizes.push_back(std::make_pair(size, i));
+  }
+  std::stable_sort(sizes.begin(), sizes.end());
+
+  std::vector< Condition > result;
+  for (std::vector< std::pair< uint64, uint > >::const_iterator it = sizes.begin(); it != sizes.end(); ++it)
+    result.push_back(conditions[it->second]);
+  return result;
+}
+
+
+/* If idx_ranges is given then the key-value pairs are only looked up for the objects within these ranges.
+ * The ids outside the ranges may or may not be part of the result. */
+template< typename Skeleton, typename Id_Type, typename Index >
 std::vector< std::pair< Id_Type, Uint31_Index > > collect_ids(
     const std::vector< std::string >& keys,
     const std::vector< std::pair< std::string, std::string > >& key_values,
@@ -369,7 +503,8 @@ std::vector< std::pair< Id_Type, Uint31_Index > > collect_ids(
     const std::vector< std::pair< Regular_Expression*, Regular_Expression* > >& regkey_regexes,
     const File_Properties& file_prop, const File_Properties& attic_file_prop,
     Resource_Manager& rman, const Statement& stmt,
-    uint64 timestamp, Query_Filter_Strategy check_keys_late, bool& result_valid)
+    uint64 timestamp, Query_Filter_Strategy check_keys_late, bool& result_valid,
+    const Ranges< Index >* idx_ranges)
 {
   if (key_values.empty() && keys.empty() && key_regexes.empty() && regkey_regexes.empty())
     return std::vector< std::pair< Id_Type, Uint31_Index > >();
@@ -386,12 +521,15 @@ std::vector< std::pair< Id_Type, Uint31_Index > > collect_ids(
   bool filtered = false;
   result_valid = false;
 
-  for (std::vector< std::pair< std::string, std::string > >::const_iterator kvit = key_values.begin();
-       kvit != key_values.end(); ++kvit)
+  std::vector< std::pair< std::string, std::string > > ordered_key_values =
+      timestamp == NOW ? order_by_index_size(key_values, tags_db) : key_values;
+  for (std::vector< std::pair< std::string, std::string > >::const_iterator kvit = ordered_key_values.begin();
+       kvit != ordered_key_values.end(); ++kvit)
   {
     if (timestamp == NOW)
     {
-      Ranges< Tag_Index_Global > tag_req = get_kv_req(kvit->first, kvit->second);
+      Ranges< Tag_Index_Global > tag_req = idx_ranges && !idx_ranges->is_global() ?
+          get_kv_req(kvit->first, kvit->second, *idx_ranges) : get_kv_req(kvit->first, kvit->second);
       filter_id_list(
           new_ids, filtered, tags_db.range_begin(tag_req), tags_db.range_end(),
           Trivial_Regex(), Trivial_Regex(), check_keys_late == prefer_ranges || check_keys_late == ids_useful);
@@ -407,7 +545,8 @@ std::vector< std::pair< Id_Type, Uint31_Index > > collect_ids(
   if (check_keys_late != prefer_ranges)
   {
     // Handle simple Keys Only
-    for (std::vector< std::string >::const_iterator kit = keys.begin(); kit != keys.end(); ++kit)
+    std::vector< std::string > ordered_keys = timestamp == NOW ? order_by_index_size(keys, tags_db) : keys;
+    for (std::vector< std::string >::const_iterator kit = ordered_keys.begin(); kit != ordered_keys.end(); ++kit)
     {
       if (timestamp == NOW)
       {
@@ -488,8 +627,10 @@ std::vector< Id_Type > collect_ids(
   std::vector< Id_Type > new_ids;
   bool filtered = false;
 
-  for (std::vector< std::pair< std::string, std::string > >::const_iterator kvit = key_values.begin();
-       kvit != key_values.end(); ++kvit)
+  std::vector< std::pair< std::string, std::string > > ordered_key_values
+      = order_by_index_size(key_values, tags_db);
+  for (std::vector< std::pair< std::string, std::string > >::const_iterator kvit = ordered_key_values.begin();
+       kvit != ordered_key_values.end(); ++kvit)
   {
     Ranges< Tag_Index_Global > tag_req = get_kv_req(kvit->first, kvit->second);
     filter_id_list(new_ids, filtered,
@@ -501,7 +642,8 @@ std::vector< Id_Type > collect_ids(
   if (check_keys_late != prefer_ranges)
   {
     // Handle simple Keys Only
-    for (std::vector< std::string >::const_iterator kit = keys.begin(); kit != keys.end(); ++kit)
+    std::vector< std::string > ordered_keys = order_by_index_size(keys, tags_db);
+    for (std::vector< std::string >::const_iterator kit = ordered_keys.begin(); kit != ordered_keys.end(); ++kit)
     {
       Ranges< Tag_Index_Global > ranges = get_k_req(*kit);
       filter_id_list(new_ids, filtered,
@@ -771,7 +913,7 @@ void progress_1(
     const std::vector< std::pair< Regular_Expression*, Regular_Expression* > >& regkey_nregexes,
     Id_Constraint< Id_Type >& ids, std::vector< Index >& range_vec,
     uint64 timestamp, Query_Filter_Strategy& check_keys_late,
-    Resource_Manager& rman, const Statement& stmt)
+    Resource_Manager& rman, const Statement& stmt, const Ranges< Index >* idx_ranges = 0)
 {
   File_Properties* file_prop = current_global_tags_file_properties< Skeleton >();
   File_Properties* attic_file_prop = attic_global_tags_file_properties< Skeleton >();
@@ -786,7 +928,7 @@ void progress_1(
     std::vector< std::pair< Id_Type, Uint31_Index > > id_idxs =
         collect_ids< Skeleton, Id_Type >(
             keys, key_values, key_regexes, regkey_regexes,
-            *file_prop, *attic_file_prop, rman, stmt, timestamp, check_keys_late, result_valid);
+            *file_prop, *attic_file_prop, rman, stmt, timestamp, check_keys_late, result_valid, idx_ranges);
     if (check_keys_late == ids_useful && !result_valid)
       check_keys_late = prefer_ranges;
     ids.invert = !result_valid;
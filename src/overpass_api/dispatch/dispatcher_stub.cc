@@ -128,7 +128,7 @@ Dispatcher_Stub::Dispatcher_Stub
       throw;
     }
     transaction = new Nonsynced_Transaction
-        (false, false, dispatcher_client->get_db_dir(), "");
+        (false, false, dispatcher_client->get_db_dir(), "", dispatcher_client->get_snapshot_dir());
 
     for (auto i : osm_base_settings().bin_idxs())
       transaction->data_index(i);
@@ -185,7 +185,7 @@ Dispatcher_Stub::Dispatcher_Stub
 	  throw;
 	}
 	area_transaction = new Nonsynced_Transaction
-            (false, false, area_dispatcher_client->get_db_dir(), "");
+            (false, false, area_dispatcher_client->get_db_dir(), "", area_dispatcher_client->get_snapshot_dir());
 	{
 	  std::ifstream version((area_dispatcher_client->get_db_dir() +
 	      "area_version").c_str());
@@ -292,6 +292,15 @@ void Dispatcher_Stub::ping() const
 }
 
 
+void Dispatcher_Stub::report_space(uint64 peak_space) const
+{
+  if (dispatcher_client)
+    dispatcher_client->report_space(peak_space);
+  if (area_dispatcher_client)
+    area_dispatcher_client->report_space(peak_space);
+}
+
+
 bool Dispatcher_Stub::all_meta_empty() const
 {
   for (auto i : meta_settings().bin_idxs())
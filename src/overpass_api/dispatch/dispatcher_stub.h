@@ -54,6 +54,7 @@ public:
 
   // Called once per minute from the resource manager
   virtual void ping() const;
+  virtual void report_space(uint64 peak_space) const;
 
   ~Dispatcher_Stub();
 
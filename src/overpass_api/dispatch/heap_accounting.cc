@@ -0,0 +1,137 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "heap_accounting.h"
+
+#include <malloc.h>
+
+#include <cstdlib>
+#include <new>
+
+
+namespace
+{
+  // Both are zero-initialized before any constructor runs and thus safe to use from static constructors
+  uint64 bytes_in_use = 0;
+  uint64 bytes_peak = 0;
+
+
+  void* tracked_malloc(std::size_t size)
+  {
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr)
+    {
+      bytes_in_use += malloc_usable_size(ptr);
+      if (bytes_in_use > bytes_peak)
+        bytes_peak = bytes_in_use;
+    }
+    return ptr;
+  }
+
+
+  void tracked_free(void* ptr)
+  {
+    if (ptr)
+    {
+      bytes_in_use -= malloc_usable_size(ptr);
+      free(ptr);
+    }
+  }
+}
+
+
+uint64 heap_bytes_in_use()
+{
+  return bytes_in_use;
+}
+
+
+uint64 heap_bytes_peak()
+{
+  return bytes_peak;
+}
+
+
+void reset_heap_bytes_peak()
+{
+  bytes_peak = bytes_in_use;
+}
+
+
+void* operator new(std::size_t size)
+{
+  void* ptr = tracked_malloc(size);
+  while (!ptr)
+  {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+    ptr = tracked_malloc(size);
+  }
+  return ptr;
+}
+
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return operator new(size);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return 0;
+  }
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return operator new(size, std::nothrow);
+}
+
+
+void operator delete(void* ptr) noexcept
+{
+  tracked_free(ptr);
+}
+
+
+void operator delete[](void* ptr) noexcept
+{
+  tracked_free(ptr);
+}
+
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  tracked_free(ptr);
+}
+
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  tracked_free(ptr);
+}
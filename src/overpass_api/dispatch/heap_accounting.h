@@ -0,0 +1,39 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__DISPATCH__HEAP_ACCOUNTING_H
+#define DE__OSM3S___OVERPASS_API__DISPATCH__HEAP_ACCOUNTING_H
+
+#include "../../template_db/types.h"
+
+
+/* The global operator new and operator delete are replaced by versions that count the bytes
+ * they hand out. This covers everything a query holds in standard containers: sets, tag stores,
+ * geometry and evaluator temporaries alike. The counters are updated in constant time per call.
+ *
+ * Memory obtained directly from malloc, e.g. the block buffers of the database files,
+ * is not counted. */
+
+uint64 heap_bytes_in_use();
+uint64 heap_bytes_peak();
+
+// Sets the peak to the current usage
+void reset_heap_bytes_peak();
+
+
+#endif
@@ -16,90 +16,16 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "heap_accounting.h"
 #include "resource_manager.h"
 #include "../data/abstract_processing.h"
 #include "../data/utils.h"
 #include "../statements/statement.h"
 
-#include <sstream>
-
-
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Node_Skeleton > >& nodes)
-{
-  uint64 size(0);
-  for (std::map< Uint32_Index, std::vector< Node_Skeleton > >::const_iterator
-      it(nodes.begin()); it != nodes.end(); ++it)
-    size += it->second.size()*8 + 64;
-  return size;
-}
-
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Way_Skeleton > >& ways)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Way_Skeleton > >::const_iterator
-      it(ways.begin()); it != ways.end(); ++it)
-    size += it->second.size()*128 + 64;
-  return size;
-}
-
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& relations)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Relation_Skeleton > >::const_iterator
-      it(relations.begin()); it != relations.end(); ++it)
-    size += it->second.size()*192 + 64;
-  return size;
-}
-
-
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >& nodes)
-{
-  uint64 size(0);
-  for (std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >::const_iterator
-      it(nodes.begin()); it != nodes.end(); ++it)
-    size += it->second.size()*16 + 64;
-  return size;
-}
-
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >& ways)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >::const_iterator
-      it(ways.begin()); it != ways.end(); ++it)
-    size += it->second.size()*136 + 64;
-  return size;
-}
-
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >& relations)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >::const_iterator
-      it(relations.begin()); it != relations.end(); ++it)
-    size += it->second.size()*200 + 64;
-  return size;
-}
-
+#include <sys/time.h>
 
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Area_Skeleton > >& areas)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Area_Skeleton > >::const_iterator
-      it(areas.begin()); it != areas.end(); ++it)
-    size += it->second.size()*128 + 64;
-  return size;
-}
-
-
-uint64 eval_set(const Set& set_)
-{
-  return eval_map(set_.nodes) + eval_map(set_.ways) + eval_map(set_.relations)
-      + eval_map(set_.attic_nodes) + eval_map(set_.attic_ways)
-      + eval_map(set_.attic_relations) + eval_map(set_.areas);
-}
+#include <algorithm>
+#include <sstream>
 
 
 Set* Runtime_Stack_Frame::get_set(const std::string& set_name)
@@ -142,7 +68,6 @@ void Runtime_Stack_Frame::swap_set(const std::string& set_name, Set& set_)
   key_values.erase(set_name);
   Set& to_swap = sets[set_name];
   set_.swap(to_swap);
-  size_per_set[set_name] = eval_set(to_swap);
 }
 
 
@@ -198,7 +123,6 @@ void Runtime_Stack_Frame::erase_set(const std::string& set_name)
   sets.erase(set_name);
   diff_sets.erase(set_name);
   key_values.erase(set_name);
-  size_per_set[set_name] = 0;
 }
 
 
@@ -207,7 +131,6 @@ void Runtime_Stack_Frame::clear_sets()
   sets.clear();
   diff_sets.clear();
   key_values.clear();
-  size_per_set.clear();
 }
 
 
@@ -219,15 +142,9 @@ void Runtime_Stack_Frame::copy_outward(const std::string& inner_set_name, const
     from = parent->get_set(inner_set_name);
 
   if (from)
-  {
-    size_per_set[top_set_name] = eval_set(*from);
     sets[top_set_name] = *from;
-  }
   else
-  {
-    size_per_set[top_set_name] = 0;
     sets[top_set_name].clear();
-  }
   diff_sets.erase(top_set_name);
   key_values.erase(top_set_name);
 }
@@ -252,7 +169,6 @@ void Runtime_Stack_Frame::move_outward(const std::string& inner_set_name, const
 
   if (source)
   {
-    size_per_set[top_set_name] = source->size_per_set[inner_set_name];
     sets[top_set_name].clear();
     if (source == parent)
       source->swap_set(inner_set_name, sets[top_set_name]);
@@ -284,8 +200,6 @@ bool Runtime_Stack_Frame::union_inward(const std::string& top_set_name, const st
 
     new_elements_found |= indexed_set_union(target.areas, source->areas);
     new_elements_found |= indexed_set_union(target.deriveds, source->deriveds);
-
-    parent->size_per_set[inner_set_name] = eval_set(target);
   }
   parent->diff_sets.erase(inner_set_name);
   parent->key_values.erase(top_set_name);
@@ -334,14 +248,19 @@ void Runtime_Stack_Frame::substract_from_inward(const std::string& top_set_name,
 
     indexed_set_difference(target.areas, source->areas);
     indexed_set_difference(target.deriveds, source->deriveds);
-
-    parent->size_per_set[inner_set_name] = eval_set(target);
   }
   parent->diff_sets.erase(inner_set_name);
   parent->key_values.erase(inner_set_name);
 }
 
 
+void Runtime_Stack_Frame::swap_inward(const std::string& inner_set_name, Set& set_)
+{
+  if (parent)
+    parent->sets[inner_set_name].swap(set_);
+}
+
+
 void Runtime_Stack_Frame::move_all_inward()
 {
   if (parent)
@@ -373,20 +292,6 @@ void Runtime_Stack_Frame::move_all_inward_except(const std::string& set_name)
 }
 
 
-uint64 Runtime_Stack_Frame::total_size()
-{
-  uint64 result = 0;
-
-  for (std::map< std::string, uint64 >::const_iterator it = size_per_set.begin(); it != size_per_set.end(); ++it)
-    result += it->second;
-
-  if (parent)
-    return result + parent->total_size();
-
-  return result;
-}
-
-
 std::vector< std::pair< uint, uint > > Runtime_Stack_Frame::stack_progress() const
 {
   std::vector< std::pair< uint, uint > > result;
@@ -404,10 +309,12 @@ Resource_Manager::Resource_Manager(
     Error_Output* error_output_)
       : transaction(&transaction_), error_output(error_output_),
         area_transaction(0), area_updater_(0),
-        watchdog(watchdog_), global_settings(global_settings_), global_settings_owned(false),
+        watchdog(watchdog_), global_settings(global_settings_), global_settings_owned(false), shared_ranges_cache_(0),
 	start_time(time(NULL)), last_ping_time(0), last_report_time(0),
-	max_allowed_time(0), max_allowed_space(0)
+	max_allowed_time(0), max_allowed_space(0), heap_baseline(heap_bytes_in_use()), query_peak(0),
+	profiling(false)
 {
+  reset_heap_bytes_peak();
   if (!global_settings)
   {
     global_settings = new Parsed_Query();
@@ -423,10 +330,12 @@ Resource_Manager::Resource_Manager(
     Transaction& area_transaction_, Watchdog_Callback* watchdog_, Area_Usage_Listener* area_updater__)
     : transaction(&transaction_), error_output(error_output_),
       area_transaction(&area_transaction_), area_updater_(area_updater__),
-      watchdog(watchdog_), global_settings(&global_settings_), global_settings_owned(false),
+      watchdog(watchdog_), global_settings(&global_settings_), global_settings_owned(false), shared_ranges_cache_(0),
       start_time(time(NULL)), last_ping_time(0), last_report_time(0),
-      max_allowed_time(0), max_allowed_space(0)
+      max_allowed_time(0), max_allowed_space(0), heap_baseline(heap_bytes_in_use()), query_peak(0),
+      profiling(false)
 {
+  reset_heap_bytes_peak();
   runtime_stack.push_back(new Runtime_Stack_Frame());
 }
 
@@ -555,6 +464,13 @@ void Resource_Manager::substract_from_inward(const std::string& top_set_name, co
 }
 
 
+void Resource_Manager::swap_inward(const std::string& inner_set_name, Set& set_)
+{
+  if (!runtime_stack.empty())
+    runtime_stack.back()->swap_inward(inner_set_name, set_);
+}
+
+
 void Resource_Manager::move_all_inward()
 {
   if (!runtime_stack.empty())
@@ -640,7 +556,10 @@ bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, ui
   if (elapsed_time >= last_ping_time + 5)
   {
     if (watchdog)
+    {
       watchdog->ping();
+      watchdog->report_space(peak_space());
+    }
     last_ping_time = elapsed_time;
 
     if (elapsed_time >= last_report_time + 15)
@@ -658,10 +577,9 @@ bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, ui
   uint64 size = 0;
   if (max_allowed_space > 0)
   {
-    if (!runtime_stack.empty())
-      size += runtime_stack.back()->total_size();
-    extra_space_uses_half_empty = (extra_space*2 >= max_allowed_space - size);
-    size += extra_space;
+    size = used_space();
+    extra_space = std::min(extra_space, size);
+    extra_space_uses_half_empty = (extra_space*2 >= max_allowed_space - (size - extra_space));
   }
 
   if (elapsed_time > max_allowed_time || size > max_allowed_space)
@@ -801,3 +719,110 @@ void Resource_Manager::stop_cpu_timer(uint index)
   if (index < cpu_start_time.size())
     cpu_runtime[index] += clock()/1000 - cpu_start_time[index];
 }
+
+
+namespace
+{
+  uint64 wall_clock_millis()
+  {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return uint64(tv.tv_sec)*1000 + tv.tv_usec/1000;
+  }
+}
+
+
+void Resource_Manager::enable_profiling()
+{
+  profiling = true;
+  block_read_statistics_enabled() = true;
+}
+
+
+void Resource_Manager::start_statement_profile(const Statement& stmt)
+{
+  std::map< const Statement*, uint >::const_iterator it = profile_index_by_stmt.find(&stmt);
+  Open_Profile open_profile;
+  if (it == profile_index_by_stmt.end())
+  {
+    open_profile.profile_index = profiles.size();
+    profile_index_by_stmt[&stmt] = profiles.size();
+    profiles.push_back(Statement_Profile(stmt.get_name(), stmt.get_line_number(), open_profiles.size()));
+  }
+  else
+    open_profile.profile_index = it->second;
+  open_profile.wall_start = wall_clock_millis();
+  open_profile.cpu_start = clock();
+  open_profile.reads_at_start = global_block_read_statistics();
+
+  update_peak_size();
+  query_peak = peak_space();
+  reset_heap_bytes_peak();
+
+  open_profiles.push_back(open_profile);
+}
+
+
+void Resource_Manager::stop_statement_profile()
+{
+  if (open_profiles.empty())
+    return;
+
+  update_peak_size();
+
+  const Open_Profile& open_profile = open_profiles.back();
+  Statement_Profile& profile = profiles[open_profile.profile_index];
+  ++profile.executions;
+  profile.wall_time += wall_clock_millis() - open_profile.wall_start;
+  profile.cpu_time += (clock() - open_profile.cpu_start)/(CLOCKS_PER_SEC/1000);
+
+  const std::map< std::string, Block_Read_Statistics >& reads = global_block_read_statistics();
+  for (std::map< std::string, Block_Read_Statistics >::const_iterator it = reads.begin(); it != reads.end(); ++it)
+  {
+    Block_Read_Statistics delta = it->second;
+    std::map< std::string, Block_Read_Statistics >::const_iterator
+        it_start = open_profile.reads_at_start.find(it->first);
+    if (it_start != open_profile.reads_at_start.end())
+    {
+      delta.blocks_read -= it_start->second.blocks_read;
+      delta.blocks_decompressed -= it_start->second.blocks_decompressed;
+      delta.bytes_read -= it_start->second.bytes_read;
+      delta.bytes_inflated -= it_start->second.bytes_inflated;
+    }
+    if (delta.blocks_read > 0)
+    {
+      Block_Read_Statistics& target = profile.reads[it->first];
+      target.blocks_read += delta.blocks_read;
+      target.blocks_decompressed += delta.blocks_decompressed;
+      target.bytes_read += delta.bytes_read;
+      target.bytes_inflated += delta.bytes_inflated;
+    }
+  }
+
+  open_profiles.pop_back();
+}
+
+
+uint64 Resource_Manager::used_space() const
+{
+  uint64 in_use = heap_bytes_in_use();
+  return in_use > heap_baseline ? in_use - heap_baseline : 0;
+}
+
+
+uint64 Resource_Manager::peak_space() const
+{
+  uint64 peak = heap_bytes_peak();
+  return std::max(query_peak, peak > heap_baseline ? peak - heap_baseline : 0);
+}
+
+
+// The heap peak is reset whenever a statement profile opens. Thus the heap peak is always
+// the peak since the last start or stop of a profile, and it belongs to all profiles open in between.
+void Resource_Manager::update_peak_size()
+{
+  uint64 peak = heap_bytes_peak();
+  peak = peak > heap_baseline ? peak - heap_baseline : 0;
+  for (std::vector< Open_Profile >::const_iterator it = open_profiles.begin(); it != open_profiles.end(); ++it)
+    profiles[it->profile_index].peak_size = std::max(profiles[it->profile_index].peak_size, peak);
+}
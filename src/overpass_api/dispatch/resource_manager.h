@@ -24,6 +24,7 @@
 #include "../core/datatypes.h"
 #include "../core/parsed_query.h"
 #include "../data/diff_set.h"
+#include "../data/shared_ranges_cache.h"
 #include "../data/user_data_cache.h"
 
 
@@ -33,6 +34,8 @@ class Statement;
 struct Watchdog_Callback
 {
   virtual void ping() const = 0;
+  // Tells the dispatcher the peak heap usage of the query so far
+  virtual void report_space(uint64 peak_space) const = 0;
 };
 
 
@@ -53,9 +56,6 @@ public:
     diff_from_timestamp(parent_ ? parent_->diff_from_timestamp : NOW),
     diff_to_timestamp(parent_ ? parent_->diff_to_timestamp : NOW) {}
 
-  // Returns the used RAM including the used RAM of parent frames
-  uint64 total_used_space() const;
-
   Set* get_set(const std::string& set_name);
   Diff_Set* get_diff_set(const std::string& set_name);
   const std::string* get_value(const std::string& set_name, const std::string& key);
@@ -71,6 +71,7 @@ public:
   bool union_inward(const std::string& top_set_name, const std::string& inner_set_name);
   void copy_inward(const std::string& top_set_name, const std::string& inner_set_name);
   void substract_from_inward(const std::string& top_set_name, const std::string& inner_set_name);
+  void swap_inward(const std::string& inner_set_name, Set& set_);
   void move_all_inward();
   void move_all_inward_except(const std::string& set_name);
 
@@ -84,7 +85,6 @@ public:
   void set_diff_from_timestamp(uint64 timestamp) { diff_from_timestamp = timestamp; }
   void set_diff_to_timestamp(uint64 timestamp) { diff_to_timestamp = timestamp; }
 
-  uint64 total_size();
   std::vector< std::pair< uint, uint > > stack_progress() const;
   void set_loop_size(uint loop_size_) { loop_size = loop_size_; }
   void count_loop() { ++loop_count; }
@@ -94,7 +94,6 @@ private:
   std::map< std::string, Set > sets;
   std::map< std::string, Diff_Set > diff_sets;
   std::map< std::string, std::map< std::string, std::string > > key_values;
-  std::map< std::string, uint64 > size_per_set;
   uint loop_count;
   uint loop_size;
 
@@ -105,6 +104,25 @@ private:
 };
 
 
+// Runtime profile of a statement, summed up over all its executions. The figures are inclusive,
+// i.e. they contain also the figures of the substatements.
+struct Statement_Profile
+{
+  Statement_Profile(const std::string& stmt_name_, uint line_number_, uint depth_)
+      : stmt_name(stmt_name_), line_number(line_number_), depth(depth_),
+      executions(0), wall_time(0), cpu_time(0), peak_size(0) {}
+
+  std::string stmt_name;
+  uint line_number;
+  uint depth;
+  uint executions;
+  uint64 wall_time;
+  uint64 cpu_time;
+  uint64 peak_size;
+  std::map< std::string, Block_Read_Statistics > reads;
+};
+
+
 class Resource_Manager
 {
 public:
@@ -142,6 +160,8 @@ public:
   bool union_inward(const std::string& top_set_name, const std::string& inner_set_name);
   void copy_inward(const std::string& top_set_name, const std::string& inner_set_name);
   void substract_from_inward(const std::string& top_set_name, const std::string& inner_set_name);
+  // Swaps the set of the enclosing frame, e.g. to spill the intermediate result of a set operation
+  void swap_inward(const std::string& inner_set_name, Set& set_);
   void move_all_inward();
   void move_all_inward_except(const std::string& set_name);
   void pop_stack_frame();
@@ -157,7 +177,12 @@ public:
 
   void log_and_display_error(std::string message);
 
+  // The used space is the heap growth since the construction of the Resource_Manager.
+  // The caller may declare a part of it as extra_space, i.e. memory it could release by returning early.
+  // Returns true if extra_space is more than the half of the space that is left to the rest.
   bool health_check(const Statement& stmt, uint32 extra_time = 0, uint64 extra_space = 0);
+  uint64 used_space() const;
+  uint64 peak_space() const;
 
   void set_limits(uint32 max_allowed_time_, uint64 max_allowed_space_)
   {
@@ -181,11 +206,31 @@ public:
 
   const std::map< uint32, std::string >& users() { return user_data_cache.users(*transaction); }
 
+  // The cache is owned by the statement that installs it and is null outside of its scope
+  Shared_Ranges_Cache* shared_ranges_cache() { return shared_ranges_cache_; }
+  void set_shared_ranges_cache(Shared_Ranges_Cache* cache) { shared_ranges_cache_ = cache; }
+
   void start_cpu_timer(uint index);
   void stop_cpu_timer(uint index);
   const std::vector< uint64 >& cpu_time() const { return cpu_runtime; }
 
+  void enable_profiling();
+  bool profiling_enabled() const { return profiling; }
+  void start_statement_profile(const Statement& stmt);
+  void stop_statement_profile();
+  const std::vector< Statement_Profile >& statement_profiles() const { return profiles; }
+
 private:
+  struct Open_Profile
+  {
+    uint profile_index;
+    uint64 wall_start;
+    clock_t cpu_start;
+    std::map< std::string, Block_Read_Statistics > reads_at_start;
+  };
+
+  void update_peak_size();
+
   std::vector< Runtime_Stack_Frame* > runtime_stack;
 
   Transaction* transaction;
@@ -196,14 +241,22 @@ private:
   Parsed_Query* global_settings;
   bool global_settings_owned;
   User_Data_Cache user_data_cache;
+  Shared_Ranges_Cache* shared_ranges_cache_;
   int start_time;
   uint32 last_ping_time;
   uint32 last_report_time;
   uint32 max_allowed_time;
   uint64 max_allowed_space;
+  uint64 heap_baseline;
+  uint64 query_peak;
 
   std::vector< clock_t > cpu_start_time;
   std::vector< uint64 > cpu_runtime;
+
+  bool profiling;
+  std::vector< Statement_Profile > profiles;
+  std::map< const Statement*, uint > profile_index_by_stmt;
+  std::vector< Open_Profile > open_profiles;
 };
 
 
@@ -221,17 +274,6 @@ private:
 };
 
 
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Node_Skeleton > >& nodes);
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Way_Skeleton > >& ways);
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& relations);
-
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >& nodes);
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >& ways);
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >& relations);
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Area_Skeleton > >& areas);
-
-
 struct Resource_Error
 {
   bool timed_out;
@@ -255,4 +297,24 @@ private:
 };
 
 
+struct Statement_Profile_Scope
+{
+  Statement_Profile_Scope(Resource_Manager& rman_, const Statement& stmt)
+      : rman(&rman_), active(rman_.profiling_enabled())
+  {
+    if (active)
+      rman->start_statement_profile(stmt);
+  }
+  ~Statement_Profile_Scope()
+  {
+    if (active)
+      rman->stop_statement_profile();
+  }
+
+private:
+  Resource_Manager* rman;
+  bool active;
+};
+
+
 #endif
@@ -55,7 +55,8 @@ int main(int argc, char *argv[])
   {
     global_settings.set_input_params(
 	get_xml_cgi(&error_output, 16*1024*1024,
-	error_output.http_method, error_output.allow_headers, error_output.has_origin));
+	error_output.http_method, error_output.allow_headers, error_output.has_origin,
+	error_output.accept_encoding));
 
     if (error_output.display_encoding_errors())
       return 0;
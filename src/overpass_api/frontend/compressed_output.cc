@@ -0,0 +1,238 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compressed_output.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+
+namespace
+{
+  std::string trim_lower(const std::string& s)
+  {
+    std::string::size_type begin = 0;
+    while (begin < s.size() && isspace(s[begin]))
+      ++begin;
+    std::string::size_type end = s.size();
+    while (end > begin && isspace(s[end-1]))
+      --end;
+
+    std::string result = s.substr(begin, end - begin);
+    for (std::string::size_type i = 0; i < result.size(); ++i)
+      result[i] = tolower(result[i]);
+    return result;
+  }
+}
+
+
+Content_Encoding negotiate_content_encoding(const std::string& accept_encoding)
+{
+  double gzip_quality = 0;
+  double zstd_quality = 0;
+  double wildcard_quality = -1;
+  bool gzip_mentioned = false;
+  bool zstd_mentioned = false;
+
+  std::string::size_type pos = 0;
+  while (pos < accept_encoding.size())
+  {
+    std::string::size_type delim_pos = accept_encoding.find(',', pos);
+    if (delim_pos == std::string::npos)
+      delim_pos = accept_encoding.size();
+    std::string item = accept_encoding.substr(pos, delim_pos - pos);
+    pos = delim_pos + 1;
+
+    double quality = 1;
+    std::string::size_type param_pos = item.find(';');
+    if (param_pos != std::string::npos)
+    {
+      std::string param = trim_lower(item.substr(param_pos + 1));
+      if (param.substr(0, 2) == "q=")
+        quality = atof(param.c_str() + 2);
+      item = item.substr(0, param_pos);
+    }
+    item = trim_lower(item);
+
+    if (item == "gzip" || item == "x-gzip")
+    {
+      gzip_quality = quality;
+      gzip_mentioned = true;
+    }
+    else if (item == "zstd")
+    {
+      zstd_quality = quality;
+      zstd_mentioned = true;
+    }
+    else if (item == "*")
+      wildcard_quality = quality;
+  }
+
+  if (!gzip_mentioned && wildcard_quality >= 0)
+    gzip_quality = wildcard_quality;
+  if (!zstd_mentioned && wildcard_quality >= 0)
+    zstd_quality = wildcard_quality;
+
+#ifdef HAVE_ZSTD
+  if (zstd_quality > 0 && zstd_quality >= gzip_quality)
+    return encoding_zstd;
+#endif
+  if (gzip_quality > 0)
+    return encoding_gzip;
+  return encoding_identity;
+}
+
+
+std::string content_encoding_name(Content_Encoding encoding)
+{
+  if (encoding == encoding_gzip)
+    return "gzip";
+  else if (encoding == encoding_zstd)
+    return "zstd";
+  return "identity";
+}
+
+
+Compressing_Streambuf::Compressing_Streambuf(std::streambuf* target_, Content_Encoding encoding_, int level)
+    : target(target_), encoding(encoding_), finished(false), in_buf(256*1024), out_buf(256*1024)
+{
+  if (encoding == encoding_gzip)
+  {
+    zstrm.zalloc = Z_NULL;
+    zstrm.zfree = Z_NULL;
+    zstrm.opaque = Z_NULL;
+    // 15 + 16 selects the gzip header instead of the zlib header
+    if (deflateInit2(&zstrm, level < 0 ? Z_DEFAULT_COMPRESSION : level,
+        Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      throw std::runtime_error("Compressing_Streambuf: deflateInit2 failed");
+  }
+#ifdef HAVE_ZSTD
+  else if (encoding == encoding_zstd)
+  {
+    zstd_strm = ZSTD_createCStream();
+    if (!zstd_strm || ZSTD_isError(ZSTD_initCStream(zstd_strm, level < 0 ? 3 : level)))
+      throw std::runtime_error("Compressing_Streambuf: ZSTD_initCStream failed");
+  }
+#endif
+  else
+    encoding = encoding_identity;
+
+  setp(&in_buf[0], &in_buf[0] + in_buf.size());
+}
+
+
+Compressing_Streambuf::~Compressing_Streambuf()
+{
+  try
+  {
+    finish();
+  }
+  catch (...) {}
+
+  if (encoding == encoding_gzip)
+    deflateEnd(&zstrm);
+#ifdef HAVE_ZSTD
+  else if (encoding == encoding_zstd)
+    ZSTD_freeCStream(zstd_strm);
+#endif
+}
+
+
+void Compressing_Streambuf::finish()
+{
+  if (finished)
+    return;
+  compress(true, true);
+  finished = true;
+}
+
+
+Compressing_Streambuf::int_type Compressing_Streambuf::overflow(int_type c)
+{
+  if (finished)
+    return traits_type::eof();
+
+  compress(false, false);
+  if (!traits_type::eq_int_type(c, traits_type::eof()))
+  {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+
+// A flush of the surrounding stream does not flush the compressor:
+// that would cut the stream into small pieces and spoil the compression ratio.
+int Compressing_Streambuf::sync()
+{
+  return 0;
+}
+
+
+void Compressing_Streambuf::compress(bool flush, bool finish)
+{
+  std::streamsize in_size = pptr() - pbase();
+
+  if (encoding == encoding_identity)
+  {
+    if (in_size > 0 && target->sputn(pbase(), in_size) != in_size)
+      throw std::runtime_error("Compressing_Streambuf: write failed");
+  }
+  else if (encoding == encoding_gzip)
+  {
+    zstrm.next_in = (Bytef*)pbase();
+    zstrm.avail_in = in_size;
+    int ret = Z_OK;
+    do
+    {
+      zstrm.next_out = (Bytef*)&out_buf[0];
+      zstrm.avail_out = out_buf.size();
+      ret = deflate(&zstrm, finish ? Z_FINISH : Z_NO_FLUSH);
+      if (ret == Z_STREAM_ERROR)
+        throw std::runtime_error("Compressing_Streambuf: deflate failed");
+      std::streamsize out_size = out_buf.size() - zstrm.avail_out;
+      if (out_size > 0 && target->sputn(&out_buf[0], out_size) != out_size)
+        throw std::runtime_error("Compressing_Streambuf: write failed");
+    }
+    while (zstrm.avail_out == 0 || (finish && ret != Z_STREAM_END));
+  }
+#ifdef HAVE_ZSTD
+  else if (encoding == encoding_zstd)
+  {
+    ZSTD_inBuffer input = { pbase(), (size_t)in_size, 0 };
+    size_t remaining = 0;
+    do
+    {
+      ZSTD_outBuffer output = { &out_buf[0], out_buf.size(), 0 };
+      remaining = ZSTD_compressStream2(zstd_strm, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+      if (ZSTD_isError(remaining))
+        throw std::runtime_error("Compressing_Streambuf: ZSTD_compressStream2 failed");
+      if (output.pos > 0 && target->sputn(&out_buf[0], output.pos) != (std::streamsize)output.pos)
+        throw std::runtime_error("Compressing_Streambuf: write failed");
+    }
+    while (input.pos < input.size || (finish && remaining > 0));
+  }
+#endif
+
+  setp(&in_buf[0], &in_buf[0] + in_buf.size());
+  if (flush)
+    target->pubsync();
+}
@@ -0,0 +1,79 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__FRONTEND__COMPRESSED_OUTPUT_H
+#define DE__OSM3S___OVERPASS_API__FRONTEND__COMPRESSED_OUTPUT_H
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#undef VERSION
+#endif
+
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+enum Content_Encoding { encoding_identity, encoding_gzip, encoding_zstd };
+
+
+/* Chooses the best encoding the client accepts according to the value of an Accept-Encoding header.
+ * Encodings with a quality value of zero are treated as not accepted. */
+Content_Encoding negotiate_content_encoding(const std::string& accept_encoding);
+
+std::string content_encoding_name(Content_Encoding encoding);
+
+
+/* Compresses everything written to it and passes the compressed data on to the target buffer.
+ * The input is collected in large chunks such that the compressor can work efficiently
+ * and the target gets few but large writes. finish() must be called to complete the stream. */
+class Compressing_Streambuf : public std::streambuf
+{
+public:
+  Compressing_Streambuf(std::streambuf* target_, Content_Encoding encoding_, int level = -1);
+  ~Compressing_Streambuf();
+
+  void finish();
+
+protected:
+  virtual int_type overflow(int_type c);
+  virtual int sync();
+
+private:
+  std::streambuf* target;
+  Content_Encoding encoding;
+  bool finished;
+  std::vector< char > in_buf;
+  std::vector< char > out_buf;
+  z_stream zstrm;
+#ifdef HAVE_ZSTD
+  ZSTD_CStream* zstd_strm;
+#endif
+
+  void compress(bool flush, bool finish);
+};
+
+
+#endif
@@ -108,7 +108,8 @@ namespace
 
 std::map< std::string, std::string > get_xml_cgi(
     Error_Output* error_output, uint32 max_input_size,
-    Http_Methods& http_method, std::string& allow_header, bool& has_origin)
+    Http_Methods& http_method, std::string& allow_header, bool& has_origin,
+    std::string& accept_encoding)
 {
   // Check for various HTTP headers
   char* method = getenv("REQUEST_METHOD");
@@ -123,6 +124,8 @@ std::map< std::string, std::string > get_xml_cgi(
   allow_header = ((allow_header_c) ? allow_header_c : "");
   char* origin = getenv("HTTP_ORIGIN");
   has_origin = ((origin) && strnlen(origin, 1) > 0);
+  char* accept_encoding_c = getenv("HTTP_ACCEPT_ENCODING");
+  accept_encoding = ((accept_encoding_c) ? accept_encoding_c : "");
 
   int line_number(1);
   // If there is nonempty input from GET method, use GET
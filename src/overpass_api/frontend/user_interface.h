@@ -27,7 +27,8 @@
 
 std::map< std::string, std::string > get_xml_cgi(
     Error_Output* error_output, uint32 max_input_size,
-    Http_Methods& http_method, std::string& allow_header, bool& has_origin);
+    Http_Methods& http_method, std::string& allow_header, bool& has_origin,
+    std::string& accept_encoding);
 
 std::string get_xml_console(Error_Output* error_output, uint32 max_input_size = 1048576);
 
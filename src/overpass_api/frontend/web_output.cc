@@ -17,6 +17,7 @@
  */
 
 #include "../../expat/escape_xml.h"
+#include "compressed_output.h"
 #include "output.h"
 #include "web_output.h"
 
@@ -171,7 +172,24 @@ void Web_Output::write_payload_header
       std::cout<<"Access-Control-Allow-Methods: GET, POST, OPTIONS\n"
             "Content-Length: 0\n";
     if (!output_handler || output_handler->write_http_headers())
+    {
+      Content_Encoding encoding =
+          output_handler ? negotiate_content_encoding(accept_encoding) : encoding_identity;
+      if (encoding != encoding_identity)
+        std::cout<<"Content-Encoding: "<<content_encoding_name(encoding)<<"\n"
+            "Vary: Accept-Encoding\n";
       std::cout<<'\n';
+
+      // Everything after the headers goes through the compressor.
+      // The web server then passes the compressed stream through as it is.
+      if (encoding != encoding_identity && http_method != http_options && http_method != http_head)
+      {
+        std::cout.flush();
+        plain_buf = std::cout.rdbuf();
+        compressor = new Compressing_Streambuf(plain_buf, encoding);
+        std::cout.rdbuf(compressor);
+      }
+    }
     if (http_method == http_options || http_method == http_head)
       return;
   }
@@ -277,6 +295,25 @@ void Web_Output::write_footer()
     output_handler->write_footer();
 
   header_written = final;
+  finish_compression();
+}
+
+
+void Web_Output::finish_compression()
+{
+  if (!compressor)
+    return;
+
+  std::cout.flush();
+  std::cout.rdbuf(plain_buf);
+  try
+  {
+    compressor->finish();
+  }
+  catch (const std::exception& e) {}
+  delete compressor;
+  compressor = 0;
+  std::cout.flush();
 }
 
 
@@ -25,11 +25,13 @@
 #include "output_handler.h"
 
 
+class Compressing_Streambuf;
+
 struct Web_Output : public Error_Output
 {
   Web_Output(uint log_level_) : http_method(http_get), has_origin(false), header_written(not_yet),
       encoding_errors(false), parse_errors(false), static_errors(false), log_level(log_level_),
-      output_handler(0) {}
+      output_handler(0), compressor(0), plain_buf(0) {}
 
   ~Web_Output() { write_footer(); }
 
@@ -67,6 +69,7 @@ public:
   Http_Methods http_method;
   std::string allow_headers;
   bool has_origin;
+  std::string accept_encoding;
 
 private:
   enum { not_yet, payload, html, final } header_written;
@@ -77,7 +80,10 @@ private:
   std::string messages;
 
   Output_Handler* output_handler;
+  Compressing_Streambuf* compressor;
+  std::streambuf* plain_buf;
 
+  void finish_compression();
   void display_remark(const std::string& text);
   void display_error(const std::string& text, uint write_mime);
 };
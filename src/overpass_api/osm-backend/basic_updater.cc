@@ -141,6 +141,74 @@ std::map< Way_Skeleton::Id_Type, std::vector< std::pair< Uint31_Index, Attic< Wa
 }
 
 
+bool parent_file_maintained(
+    Transaction& transaction, const File_Properties& parent_file, const File_Properties& skeleton_file)
+{
+  std::string db_dir = transaction.get_db_dir();
+  return file_exists(db_dir + parent_file.get_file_name_trunk()
+          + parent_file.get_data_suffix() + parent_file.get_index_suffix())
+      || !file_exists(db_dir + skeleton_file.get_file_name_trunk()
+          + skeleton_file.get_data_suffix() + skeleton_file.get_index_suffix());
+}
+
+
+bool collect_parents_by_reverse_index(
+    Transaction& transaction, const File_Properties& parent_file, const std::vector< Uint64 >& child_ids,
+    std::set< Uint31_Index >& parent_idxs, std::vector< Parent_Entry::Id_Type >& parent_ids)
+{
+  if (!file_exists(transaction.get_db_dir() + parent_file.get_file_name_trunk()
+      + parent_file.get_data_suffix() + parent_file.get_index_suffix()))
+    return false;
+
+  Block_Backend< Uint64, Parent_Entry, std::vector< Uint64 >::const_iterator > db
+      (transaction.data_index(&parent_file));
+  for (Block_Backend< Uint64, Parent_Entry, std::vector< Uint64 >::const_iterator >::Discrete_Iterator
+      it(db.discrete_begin(child_ids.begin(), child_ids.end())); !(it == db.discrete_end()); ++it)
+  {
+    parent_idxs.insert(it.object().idx);
+    parent_ids.push_back(it.object().id);
+  }
+  std::sort(parent_ids.begin(), parent_ids.end());
+  parent_ids.erase(std::unique(parent_ids.begin(), parent_ids.end()), parent_ids.end());
+
+  return true;
+}
+
+
+void add_parent_entries(const std::map< Uint31_Index, std::set< Way_Skeleton > >& skeletons,
+    std::map< Uint64, std::set< Parent_Entry > >& entries)
+{
+  for (std::map< Uint31_Index, std::set< Way_Skeleton > >::const_iterator it = skeletons.begin();
+       it != skeletons.end(); ++it)
+  {
+    for (std::set< Way_Skeleton >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+    {
+      for (std::vector< Node::Id_Type >::const_iterator it3 = it2->nds.begin(); it3 != it2->nds.end(); ++it3)
+        entries[*it3].insert(Parent_Entry(it->first, it2->id));
+    }
+  }
+}
+
+
+void add_parent_entries(const std::map< Uint31_Index, std::set< Relation_Skeleton > >& skeletons,
+    uint32 member_type, std::map< Uint64, std::set< Parent_Entry > >& entries)
+{
+  for (std::map< Uint31_Index, std::set< Relation_Skeleton > >::const_iterator it = skeletons.begin();
+       it != skeletons.end(); ++it)
+  {
+    for (std::set< Relation_Skeleton >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+    {
+      for (std::vector< Relation_Entry >::const_iterator it3 = it2->members.begin();
+           it3 != it2->members.end(); ++it3)
+      {
+        if (it3->type == member_type)
+          entries[it3->ref].insert(Parent_Entry(it->first, it2->id));
+      }
+    }
+  }
+}
+
+
 void Cpu_Stopwatch::start_cpu_timer(uint index)
 {
   if (cpu_start_time.size() <= index)
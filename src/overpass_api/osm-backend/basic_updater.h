@@ -164,8 +164,18 @@ std::map< Index, std::set< Element_Skeleton > > get_existing_skeletons
   std::map< Index, std::set< Element_Skeleton > > result;
   Idx_Agnostic_Compare< Index, typename Element_Skeleton::Id_Type > comp;
 
+  std::vector< typename Element_Skeleton::Id_Type > ids;
+  if (ids_with_position.size() <= Block_Id_Filter::MAX_IDS)
+  {
+    for (auto it = ids_with_position.begin(); it != ids_with_position.end(); ++it)
+      ids.push_back(it->first);
+  }
+  Block_Id_Filter filter(ids.begin(), ids.end());
+
   Block_Backend< Index, Element_Skeleton > db(transaction.data_index(&file_properties));
-  for (auto it = db.discrete_begin(req.begin(), req.end()); !(it == db.discrete_end()); ++it)
+  for (auto it = ids.empty() ? db.discrete_begin(req.begin(), req.end())
+          : db.discrete_begin(req.begin(), req.end(), filter);
+      !(it == db.discrete_end()); ++it)
   {
     if (binary_search(ids_with_position.begin(), ids_with_position.end(),
         std::make_pair(it.object().id, 0), comp))
@@ -1148,6 +1158,28 @@ std::map< Way_Skeleton::Id_Type, std::vector< std::pair< Uint31_Index, Attic< Wa
         const std::map< Way_Skeleton::Id_Type, Uint31_Index >& new_way_idx_by_id);
 
 
+/* The reverse membership files are written for a database that starts empty.
+ * They are absent in databases from before and are then not started with a later update. */
+bool parent_file_maintained(
+    Transaction& transaction, const File_Properties& parent_file, const File_Properties& skeleton_file);
+
+
+/* Looks up in the reverse membership file the index and the id of every parent of the given children.
+ * The child ids must be sorted. Returns false if the file does not exist. Then the caller must scan
+ * the skeletons in the parent indices of the children instead. */
+bool collect_parents_by_reverse_index(
+    Transaction& transaction, const File_Properties& parent_file, const std::vector< Uint64 >& child_ids,
+    std::set< Uint31_Index >& parent_idxs, std::vector< Parent_Entry::Id_Type >& parent_ids);
+
+
+/* Adds for every member the entry that refers back to the skeleton. */
+void add_parent_entries(const std::map< Uint31_Index, std::set< Way_Skeleton > >& skeletons,
+    std::map< Uint64, std::set< Parent_Entry > >& entries);
+
+void add_parent_entries(const std::map< Uint31_Index, std::set< Relation_Skeleton > >& skeletons,
+    uint32 member_type, std::map< Uint64, std::set< Parent_Entry > >& entries);
+
+
 struct Cpu_Stopwatch
 {
   void start_cpu_timer(uint index);
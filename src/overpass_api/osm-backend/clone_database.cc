@@ -265,6 +265,15 @@ void clone_changelog_file(Transaction& transaction, std::string dest_db_dir, con
       *changelog_file_properties< Skeleton >(), transaction, dest_db_dir, clone_settings);
 }
 
+// A reverse membership file is only valid if it has been kept since the database was created
+void clone_parents_file(const File_Properties& file_prop,
+    Transaction& transaction, std::string dest_db_dir, const Clone_Settings& clone_settings)
+{
+  if (file_exists(transaction.get_db_dir() + file_prop.get_file_name_trunk()
+      + file_prop.get_data_suffix() + file_prop.get_index_suffix()))
+    clone_matching_bin_file< Uint64, Parent_Entry >(file_prop, transaction, dest_db_dir, clone_settings);
+}
+
 
 void clone_database(Transaction& transaction, const std::string& dest_db_dir, const Clone_Settings& clone_settings)
 {
@@ -291,6 +300,11 @@ void clone_database(Transaction& transaction, const std::string& dest_db_dir, co
   clone_matching_bin_file< Uint32_Index, String_Object >(
       *osm_base_settings().RELATION_ROLES, transaction, dest_db_dir, clone_settings);
 
+  clone_parents_file(*osm_base_settings().NODE_WAYS, transaction, dest_db_dir, clone_settings);
+  clone_parents_file(*osm_base_settings().NODE_RELATIONS, transaction, dest_db_dir, clone_settings);
+  clone_parents_file(*osm_base_settings().WAY_RELATIONS, transaction, dest_db_dir, clone_settings);
+  clone_parents_file(*osm_base_settings().RELATION_RELATIONS, transaction, dest_db_dir, clone_settings);
+
   clone_meta_file< Node::Index, Node_Skeleton >(transaction, dest_db_dir, clone_settings);
   clone_meta_file< Way::Index, Way_Skeleton >(transaction, dest_db_dir, clone_settings);
   clone_meta_file< Relation::Index, Relation_Skeleton >(transaction, dest_db_dir, clone_settings);
@@ -121,6 +121,11 @@ void Transaction_Collection::remove_referred_files(const File_Properties& file_p
   }
 }
 
+std::string bulk_run_extension(uint32 run)
+{
+  return ".run" + std::to_string(run);
+}
+
 void rename_referred_file(const std::string& db_dir, const std::string& from, const std::string& to,
 			  const File_Properties& file_prop)
 {
@@ -200,6 +200,12 @@ void collect_old_meta_data
 void rename_referred_file(const std::string& db_dir, const std::string& from, const std::string& to,
 			  const File_Properties& file_prop);
 
+// The number of sorted runs of a bulk import that are merged at once
+const unsigned int MAX_BULK_RUNS = 64;
+
+// The file name extension of the n-th sorted run of a bulk import
+std::string bulk_run_extension(uint32 run);
+
 class Transaction_Collection
 {
   public:
@@ -262,36 +268,71 @@ void merge_files
       if (!(from_its.back().first == from_its.back().second))
         current_idxs.insert(from_its.back().first.index());
     }
-    while (!current_idxs.empty())
+
+    if (into_transaction.data_index(&file_prop)->empty())
     {
-      TIndex current_idx = *current_idxs.begin();
-      current_idxs.erase(current_idxs.begin());
-      for (typename std::vector< std::pair< typename Block_Backend< TIndex, TObject >::Flat_Iterator,
-	      typename Block_Backend< TIndex, TObject >::Flat_Iterator > >::iterator
-	  it = from_its.begin(); it != from_its.end(); ++it)
+      // The runs are merged in a single pass, and every block of the result is written once
+      Block_Backend_Appender< TIndex, TObject > into_db(into_transaction.data_index(&file_prop));
+      while (!current_idxs.empty())
       {
-	while (!(it->first == it->second) && (it->first.index() == current_idx))
-	{
-	  db_to_insert[it->first.index()].insert(it->first.object());
-	  ++(it->first);
-
-	  if (++item_count > 4*1024*1024)
-	  {
-	    Block_Backend< TIndex, TObject > into_db
-	        (into_transaction.data_index(&file_prop));
-	    into_db.update(db_to_delete, db_to_insert);
-	    db_to_insert.clear();
-	    item_count = 0;
-	  }
-	}
-	if (!(it->first == it->second))
-	  current_idxs.insert(it->first.index());
+        TIndex current_idx = *current_idxs.begin();
+        current_idxs.erase(current_idxs.begin());
+        std::set< TObject > objects;
+        for (typename std::vector< std::pair< typename Block_Backend< TIndex, TObject >::Flat_Iterator,
+            typename Block_Backend< TIndex, TObject >::Flat_Iterator > >::iterator
+            it = from_its.begin(); it != from_its.end(); ++it)
+        {
+          while (!(it->first == it->second) && (it->first.index() == current_idx))
+          {
+            objects.insert(it->first.object());
+            ++(it->first);
+
+            if (objects.size() > 4*1024*1024)
+            {
+              into_db.append(current_idx, objects);
+              objects.clear();
+            }
+          }
+          if (!(it->first == it->second))
+            current_idxs.insert(it->first.index());
+        }
+        into_db.append(current_idx, objects);
       }
+      into_db.finish();
     }
+    else
+    {
+      while (!current_idxs.empty())
+      {
+        TIndex current_idx = *current_idxs.begin();
+        current_idxs.erase(current_idxs.begin());
+        for (typename std::vector< std::pair< typename Block_Backend< TIndex, TObject >::Flat_Iterator,
+            typename Block_Backend< TIndex, TObject >::Flat_Iterator > >::iterator
+            it = from_its.begin(); it != from_its.end(); ++it)
+        {
+          while (!(it->first == it->second) && (it->first.index() == current_idx))
+          {
+            db_to_insert[it->first.index()].insert(it->first.object());
+            ++(it->first);
+
+            if (++item_count > 4*1024*1024)
+            {
+              Block_Backend< TIndex, TObject > into_db
+                  (into_transaction.data_index(&file_prop));
+              into_db.update(db_to_delete, db_to_insert);
+              db_to_insert.clear();
+              item_count = 0;
+            }
+          }
+          if (!(it->first == it->second))
+            current_idxs.insert(it->first.index());
+        }
+      }
 
-    Block_Backend< TIndex, TObject > into_db
-        (into_transaction.data_index(&file_prop));
-    into_db.update(db_to_delete, db_to_insert);
+      Block_Backend< TIndex, TObject > into_db
+          (into_transaction.data_index(&file_prop));
+      into_db.update(db_to_delete, db_to_insert);
+    }
   }
   from_transaction.remove_referred_files(file_prop);
 }
@@ -446,14 +446,15 @@ std::map< Timestamp, std::vector< Node_Skeleton::Id_Type > > compute_changelog(
 
 Node_Updater::Node_Updater(Transaction& transaction_, Database_Meta_State::Mode meta_)
   : update_counter(0), transaction(&transaction_),
-    external_transaction(true), partial_possible(false), meta(meta_), keys(*osm_base_settings().NODE_KEYS)
+    external_transaction(true), partial_possible(false), bulk_import(false),
+    meta(meta_), keys(*osm_base_settings().NODE_KEYS)
 {}
 
-Node_Updater::Node_Updater(std::string db_dir_, Database_Meta_State::Mode meta_)
+Node_Updater::Node_Updater(std::string db_dir_, Database_Meta_State::Mode meta_, bool bulk_import_)
   : update_counter(0), transaction(0),
     external_transaction(false),
     partial_possible(meta_ == Database_Meta_State::only_data || meta_ == Database_Meta_State::keep_meta),
-    db_dir(db_dir_), meta(meta_), keys(*osm_base_settings().NODE_KEYS)
+    bulk_import(bulk_import_), db_dir(db_dir_), meta(meta_), keys(*osm_base_settings().NODE_KEYS)
 {
   partial_possible = !file_exists
       (db_dir +
@@ -688,7 +689,9 @@ void Node_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_sto
     new_attic_skeletons.clear();
   }
 
-  if (partial_possible && !partial && (update_counter > 0))
+  if (partial_possible && bulk_import)
+    update_bulk_runs(callback, partial);
+  else if (partial_possible && !partial && (update_counter > 0))
   {
     callback->partial_started();
 
@@ -794,6 +797,39 @@ void Node_Updater::update_node_ids
 }
 
 
+void Node_Updater::update_bulk_runs(Osm_Backend_Callback* callback, bool partial)
+{
+  if (!partial && bulk_runs.empty())
+    return;
+
+  std::string run = bulk_run_extension(update_counter++);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().NODES);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().NODE_TAGS_LOCAL);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().NODE_TAGS_GLOBAL);
+  if (meta != Database_Meta_State::only_data)
+    rename_referred_file(db_dir, "", run, *meta_settings().NODES_META);
+  bulk_runs.push_back(run);
+
+  if (partial && bulk_runs.size() < MAX_BULK_RUNS)
+    return;
+
+  callback->partial_started();
+  if (partial)
+  {
+    // Keep the number of open files bounded
+    std::string into = bulk_run_extension(update_counter++);
+    merge_files(bulk_runs, into);
+    bulk_runs = std::vector< std::string >(1, into);
+  }
+  else
+  {
+    merge_files(bulk_runs, "");
+    bulk_runs.clear();
+  }
+  callback->partial_finished();
+}
+
+
 void Node_Updater::merge_files(const std::vector< std::string >& froms, std::string into)
 {
   Transaction_Collection from_transactions(false, false, db_dir, froms);
@@ -36,7 +36,9 @@ struct Node_Updater
 {
   Node_Updater(Transaction& transaction, Database_Meta_State::Mode meta);
 
-  Node_Updater(std::string db_dir, Database_Meta_State::Mode meta);
+  // With bulk_import, every flush into an empty database is kept as a sorted run,
+  // and the runs are merged at the end in a single pass.
+  Node_Updater(std::string db_dir, Database_Meta_State::Mode meta, bool bulk_import = false);
 
   void set_id_deleted(Node::Id_Type id, const OSM_Element_Metadata* meta = 0)
   {
@@ -93,6 +95,8 @@ private:
   Transaction* transaction;
   bool external_transaction;
   bool partial_possible;
+  bool bulk_import;
+  std::vector< std::string > bulk_runs;
   static Node_Comparator_By_Id node_comparator_by_id;
   static Node_Equal_Id node_equal_id;
   std::string db_dir;
@@ -116,6 +120,7 @@ private:
       const std::vector< std::pair< Node_Skeleton::Id_Type, Uint31_Index > >& new_idx_positions);
 
   void merge_files(const std::vector< std::string >& froms, std::string into);
+  void update_bulk_runs(Osm_Backend_Callback* callback, bool partial);
 };
 
 
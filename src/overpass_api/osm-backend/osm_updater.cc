@@ -502,7 +502,7 @@ void parse_relations_only(FILE* in)
 
 Osm_Updater::Osm_Updater(Osm_Backend_Callback* callback_, const std::string& data_version_,
 			 Database_Meta_State meta_, unsigned int flush_limit_)
-  : dispatcher_client(0), meta(Database_Meta_State::only_data)
+  : dispatcher_client(0), meta(Database_Meta_State::only_data), bulk_import(false)
 {
   dispatcher_client = new Dispatcher_Client(osm_base_settings().shared_name);
   Logger logger(dispatcher_client->get_db_dir());
@@ -541,8 +541,9 @@ Osm_Updater::Osm_Updater(Osm_Backend_Callback* callback_, const std::string& dat
 
 Osm_Updater::Osm_Updater
     (Osm_Backend_Callback* callback_, std::string db_dir, const std::string& data_version_,
-     Database_Meta_State meta_, unsigned int flush_limit_)
-  : transaction(0), dispatcher_client(0), db_dir_(db_dir), meta(Database_Meta_State::only_data)
+     Database_Meta_State meta_, unsigned int flush_limit_, bool bulk_import_)
+  : transaction(0), dispatcher_client(0), db_dir_(db_dir), meta(Database_Meta_State::only_data),
+    bulk_import(bulk_import_)
 {
   if (file_present(db_dir + osm_base_settings().shared_name))
     throw Context_Error("File " + db_dir + osm_base_settings().shared_name + " present, "
@@ -555,8 +556,14 @@ Osm_Updater::Osm_Updater
   
   meta = meta_.value_or_autodetect(db_dir);
 
-  node_updater_ = new Node_Updater(db_dir, meta);
-  way_updater_ = new Way_Updater(db_dir, meta);
+  if (bulk_import && meta == Database_Meta_State::keep_attic)
+    throw Context_Error("A bulk import cannot keep attic data.");
+  if (bulk_import && file_exists(db_dir + osm_base_settings().NODES->get_file_name_trunk()
+      + osm_base_settings().NODES->get_data_suffix() + osm_base_settings().NODES->get_index_suffix()))
+    throw Context_Error("A bulk import needs an empty database directory.");
+
+  node_updater_ = new Node_Updater(db_dir, meta, bulk_import);
+  way_updater_ = new Way_Updater(db_dir, meta, bulk_import);
   relation_updater_ = new Relation_Updater(db_dir, meta);
   flush_limit = flush_limit_;
 
@@ -577,9 +584,9 @@ Osm_Updater::Osm_Updater
 void Osm_Updater::flush()
 {
   delete node_updater_;
-  node_updater_ = new Node_Updater(db_dir_, meta);
+  node_updater_ = new Node_Updater(db_dir_, meta, bulk_import);
   delete way_updater_;
-  way_updater_ = new Way_Updater(db_dir_, meta);
+  way_updater_ = new Way_Updater(db_dir_, meta, bulk_import);
   delete relation_updater_;
   relation_updater_ = new Relation_Updater(db_dir_, meta);
   if (cpu_stopwatch)
@@ -36,7 +36,7 @@ class Osm_Updater
     Osm_Updater(Osm_Backend_Callback* callback_, const std::string& data_version,
 		Database_Meta_State meta, unsigned int flush_limit);
     Osm_Updater(Osm_Backend_Callback* callback_, std::string db_dir, const std::string& data_version,
-		Database_Meta_State meta, unsigned int flush_limit);
+		Database_Meta_State meta, unsigned int flush_limit, bool bulk_import = false);
     ~Osm_Updater();
 
     void finish_updater();
@@ -50,6 +50,7 @@ class Osm_Updater
     Relation_Updater* relation_updater_;
     std::string db_dir_;
     Database_Meta_State::Mode meta;
+    bool bulk_import;
 
     void flush();
 };
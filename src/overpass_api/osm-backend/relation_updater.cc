@@ -87,14 +87,6 @@ std::map< Uint31_Index, std::set< Relation_Skeleton > > get_implicitly_moved_ske
      const std::map< Uint31_Index, std::set< Relation_Skeleton > >& already_known_skeletons,
      Transaction& transaction, const File_Properties& file_properties)
 {
-  std::set< Uint31_Index > member_req;
-  for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
-    member_req.insert(Uint31_Index(it->first.val()));
-  for (std::map< Uint31_Index, std::set< Way_Skeleton > >::const_iterator
-      it = attic_ways.begin(); it != attic_ways.end(); ++it)
-    member_req.insert(it->first);
-  std::set< Uint31_Index > req = calc_parents(member_req);
-
   std::vector< Node_Skeleton::Id_Type > node_ids;
   for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
   {
@@ -114,6 +106,32 @@ std::map< Uint31_Index, std::set< Relation_Skeleton > > get_implicitly_moved_ske
   std::sort(way_ids.begin(), way_ids.end());
   way_ids.erase(std::unique(way_ids.begin(), way_ids.end()), way_ids.end());
 
+  // Both reverse membership files are started together, hence either both or none are available
+  std::set< Uint31_Index > req;
+  std::vector< Relation_Skeleton::Id_Type > parent_ids;
+  std::vector< Uint64 > way_ids_64;
+  for (std::vector< Way_Skeleton::Id_Type >::const_iterator it = way_ids.begin(); it != way_ids.end(); ++it)
+    way_ids_64.push_back(it->val());
+  bool by_reverse_index = collect_parents_by_reverse_index(
+          transaction, *osm_base_settings().NODE_RELATIONS, node_ids, req, parent_ids)
+      && collect_parents_by_reverse_index(
+          transaction, *osm_base_settings().WAY_RELATIONS, way_ids_64, req, parent_ids);
+  if (by_reverse_index)
+  {
+    std::sort(parent_ids.begin(), parent_ids.end());
+    parent_ids.erase(std::unique(parent_ids.begin(), parent_ids.end()), parent_ids.end());
+  }
+  else
+  {
+    std::set< Uint31_Index > member_req;
+    for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
+      member_req.insert(Uint31_Index(it->first.val()));
+    for (std::map< Uint31_Index, std::set< Way_Skeleton > >::const_iterator
+        it = attic_ways.begin(); it != attic_ways.end(); ++it)
+      member_req.insert(it->first);
+    req = calc_parents(member_req);
+  }
+
   std::vector< Relation_Skeleton::Id_Type > known_relation_ids;
   for (std::map< Uint31_Index, std::set< Relation_Skeleton > >::const_iterator
       it = already_known_skeletons.begin(); it != already_known_skeletons.end(); ++it)
@@ -129,6 +147,8 @@ std::map< Uint31_Index, std::set< Relation_Skeleton > > get_implicitly_moved_ske
   Block_Backend< Uint31_Index, Relation_Skeleton, std::set< Uint31_Index >::const_iterator > db(transaction.data_index(&file_properties));
   for (auto it = db.discrete_begin(req.begin(), req.end()); !(it == db.discrete_end()); ++it)
   {
+    if (by_reverse_index && !binary_search(parent_ids.begin(), parent_ids.end(), it.object().id))
+      continue;
     if (binary_search(known_relation_ids.begin(), known_relation_ids.end(), it.object().id))
       continue;
     for (std::vector< Relation_Entry >::const_iterator nit = it.object().members.begin();
@@ -1044,6 +1064,19 @@ std::map< Timestamp, std::vector< Relation_Skeleton::Id_Type > > compute_changel
 }
 
 
+void update_parents(
+    const std::map< Uint31_Index, std::set< Relation_Skeleton > >& attic_skeletons,
+    const std::map< Uint31_Index, std::set< Relation_Skeleton > >& new_skeletons,
+    uint32 member_type, Transaction& transaction, const File_Properties& file_properties)
+{
+  std::map< Uint64, std::set< Parent_Entry > > attic_parents;
+  std::map< Uint64, std::set< Parent_Entry > > new_parents;
+  add_parent_entries(attic_skeletons, member_type, attic_parents);
+  add_parent_entries(new_skeletons, member_type, new_parents);
+  update_elements(attic_parents, new_parents, transaction, file_properties);
+}
+
+
 void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stopwatch,
               const std::map< Node::Index, std::set< Node_Skeleton > >& new_node_skeletons,
               const std::map< Node::Index, std::set< Node_Skeleton > >& attic_node_skeletons,
@@ -1057,6 +1090,8 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
 
   if (!external_transaction)
     transaction = new Nonsynced_Transaction(true, false, db_dir, "");
+  bool parents_maintained
+      = parent_file_maintained(*transaction, *osm_base_settings().NODE_RELATIONS, *osm_base_settings().RELATIONS);
 
   // Prepare collecting all data of existing skeletons
   std::stable_sort(new_data.data.begin(), new_data.data.end());
@@ -1169,6 +1204,17 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
   update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().RELATIONS);
   callback->update_coords_finished();
 
+  // Update the reverse membership of the members
+  if (parents_maintained)
+  {
+    update_parents(attic_skeletons, new_skeletons, Relation_Entry::NODE,
+        *transaction, *osm_base_settings().NODE_RELATIONS);
+    update_parents(attic_skeletons, new_skeletons, Relation_Entry::WAY,
+        *transaction, *osm_base_settings().WAY_RELATIONS);
+    update_parents(attic_skeletons, new_skeletons, Relation_Entry::RELATION,
+        *transaction, *osm_base_settings().RELATION_RELATIONS);
+  }
+
   // Update meta
   if (meta)
     update_elements(attic_meta, new_meta, *transaction, *meta_settings().RELATIONS_META);
@@ -36,6 +36,7 @@ int main(int argc, char* argv[])
   // read command line arguments
   std::string db_dir, data_version;
   bool transactional = true;
+  bool bulk_import = false;
   Database_Meta_State meta;
   bool abort = false;
   unsigned int flush_limit = 16*1024*1024;
@@ -58,6 +59,8 @@ int main(int argc, char* argv[])
       meta.set_mode(Database_Meta_State::keep_meta);
     else if (!(strncmp(argv[argpos], "--keep-attic", 12)))
       meta.set_mode(Database_Meta_State::keep_attic);
+    else if (!(strncmp(argv[argpos], "--bulk-import", 13)))
+      bulk_import = true;
     else if (!(strncmp(argv[argpos], "--flush-size=", 13)))
     {
       flush_limit = atoll(std::string(argv[argpos]).substr(13).c_str()) *1024*1024;
@@ -111,13 +114,18 @@ int main(int argc, char* argv[])
     }
     ++argpos;
   }
+  if (bulk_import && transactional)
+  {
+    std::cerr<<"--bulk-import works only together with --db-dir.\n";
+    abort = true;
+  }
   if (abort)
   {
 #ifdef HAVE_LZ4
-    std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush-size=FLUSH_SIZE]"
+    std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush-size=FLUSH_SIZE] [--bulk-import]"
         " [--compression-method=(no|gz|lz4)] [--map-compression-method=(no|gz|lz4)]\n";
 #else
-    std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush-size=FLUSH_SIZE]"
+    std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush-size=FLUSH_SIZE] [--bulk-import]"
         " [--compression-method=(no|gz)] [--map-compression-method=(no|gz)]\n";
 #endif
     return 1;
@@ -133,7 +141,7 @@ int main(int argc, char* argv[])
     }
     else
     {
-      Osm_Updater osm_updater(get_verbatim_callback(), db_dir, data_version, meta, flush_limit);
+      Osm_Updater osm_updater(get_verbatim_callback(), db_dir, data_version, meta, flush_limit, bulk_import);
       //reading the main document
       osm_updater.parse_file_completely(stdin);
     }
@@ -39,12 +39,14 @@
 
 Way_Updater::Way_Updater(Transaction& transaction_, Database_Meta_State::Mode meta_)
   : update_counter(0), transaction(&transaction_),
-    external_transaction(true), partial_possible(false), meta(meta_), keys(*osm_base_settings().WAY_KEYS)
+    external_transaction(true), partial_possible(false), bulk_import(false),
+    meta(meta_), keys(*osm_base_settings().WAY_KEYS)
 {}
 
-Way_Updater::Way_Updater(std::string db_dir_, Database_Meta_State::Mode meta_)
+Way_Updater::Way_Updater(std::string db_dir_, Database_Meta_State::Mode meta_, bool bulk_import_)
   : update_counter(0), transaction(0),
-    external_transaction(false), partial_possible(true), db_dir(db_dir_), meta(meta_),
+    external_transaction(false), partial_possible(true), bulk_import(bulk_import_),
+    db_dir(db_dir_), meta(meta_),
     keys(*osm_base_settings().WAY_KEYS)
 {
   partial_possible = !file_exists
@@ -421,16 +423,14 @@ void compute_new_attic_skeletons
 }
 
 
+/* The ways of the moved nodes are found through the reverse membership file if it is maintained.
+ * Otherwise all ways in the parent indices of the moved nodes must be scanned. On large mechanical
+ * edits these are many blocks on the coarse levels of which only a few ways are affected. */
 std::map< Uint31_Index, std::set< Way_Skeleton > > get_implicitly_moved_skeletons
     (const std::map< Uint32_Index, std::set< Node_Skeleton > >& attic_nodes,
      const std::map< Uint31_Index, std::set< Way_Skeleton > >& already_known_skeletons,
      Transaction& transaction, const File_Properties& file_properties)
 {
-  std::set< Uint31_Index > node_req;
-  for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
-    node_req.insert(Uint31_Index(it->first.val()));
-  std::set< Uint31_Index > req = calc_parents(node_req);
-
   std::vector< Node_Skeleton::Id_Type > node_ids;
   for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
   {
@@ -440,6 +440,18 @@ std::map< Uint31_Index, std::set< Way_Skeleton > > get_implicitly_moved_skeleton
   std::sort(node_ids.begin(), node_ids.end());
   node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
 
+  std::set< Uint31_Index > req;
+  std::vector< Way_Skeleton::Id_Type > parent_ids;
+  bool by_reverse_index = collect_parents_by_reverse_index(
+      transaction, *osm_base_settings().NODE_WAYS, node_ids, req, parent_ids);
+  if (!by_reverse_index)
+  {
+    std::set< Uint31_Index > node_req;
+    for (auto it = attic_nodes.begin(); it != attic_nodes.end(); ++it)
+      node_req.insert(Uint31_Index(it->first.val()));
+    req = calc_parents(node_req);
+  }
+
   std::vector< Way_Skeleton::Id_Type > known_way_ids;
   for (std::map< Uint31_Index, std::set< Way_Skeleton > >::const_iterator
       it = already_known_skeletons.begin(); it != already_known_skeletons.end(); ++it)
@@ -455,6 +467,8 @@ std::map< Uint31_Index, std::set< Way_Skeleton > > get_implicitly_moved_skeleton
   Block_Backend< Uint31_Index, Way_Skeleton, std::set< Uint31_Index >::const_iterator > db(transaction.data_index(&file_properties));
   for (auto it = db.discrete_begin(req.begin(), req.end()); !(it == db.discrete_end()); ++it)
   {
+    if (by_reverse_index && !binary_search(parent_ids.begin(), parent_ids.end(), it.object().id))
+      continue;
     if (binary_search(known_way_ids.begin(), known_way_ids.end(), it.object().id))
       continue;
     for (std::vector< Node::Id_Type >::const_iterator nit = it.object().nds.begin();
@@ -784,6 +798,8 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
 
   if (!external_transaction)
     transaction = new Nonsynced_Transaction(true, false, db_dir, "");
+  bool parents_maintained
+      = parent_file_maintained(*transaction, *osm_base_settings().NODE_WAYS, *osm_base_settings().WAYS);
 
   // Prepare collecting all data of existing skeletons
   std::stable_sort(new_data.data.begin(), new_data.data.end());
@@ -893,6 +909,16 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
   update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().WAYS);
   callback->update_coords_finished();
 
+  // Update the reverse membership of the nodes
+  if (parents_maintained)
+  {
+    std::map< Uint64, std::set< Parent_Entry > > attic_parents;
+    std::map< Uint64, std::set< Parent_Entry > > new_parents;
+    add_parent_entries(attic_skeletons, attic_parents);
+    add_parent_entries(new_skeletons, new_parents);
+    update_elements(attic_parents, new_parents, *transaction, *osm_base_settings().NODE_WAYS);
+  }
+
   // Update meta
   if (meta)
   {
@@ -1044,7 +1070,9 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
     new_attic_skeletons.clear();
   }
 
-  if (partial_possible && !partial && (update_counter > 0))
+  if (partial_possible && bulk_import)
+    update_bulk_runs(callback, partial);
+  else if (partial_possible && !partial && (update_counter > 0))
   {
     callback->partial_started();
 
@@ -1082,6 +1110,7 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
     rename_referred_file(db_dir, "", to, *osm_base_settings().WAYS);
     rename_referred_file(db_dir, "", to, *osm_base_settings().WAY_TAGS_LOCAL);
     rename_referred_file(db_dir, "", to, *osm_base_settings().WAY_TAGS_GLOBAL);
+    rename_referred_file(db_dir, "", to, *osm_base_settings().NODE_WAYS);
     if (meta)
       rename_referred_file(db_dir, "", to, *meta_settings().WAYS_META);
 
@@ -1124,6 +1153,40 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
 }
 
 
+void Way_Updater::update_bulk_runs(Osm_Backend_Callback* callback, bool partial)
+{
+  if (!partial && bulk_runs.empty())
+    return;
+
+  std::string run = bulk_run_extension(update_counter++);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().WAYS);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().WAY_TAGS_LOCAL);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().WAY_TAGS_GLOBAL);
+  rename_referred_file(db_dir, "", run, *osm_base_settings().NODE_WAYS);
+  if (meta)
+    rename_referred_file(db_dir, "", run, *meta_settings().WAYS_META);
+  bulk_runs.push_back(run);
+
+  if (partial && bulk_runs.size() < MAX_BULK_RUNS)
+    return;
+
+  callback->partial_started();
+  if (partial)
+  {
+    // Keep the number of open files bounded
+    std::string into = bulk_run_extension(update_counter++);
+    merge_files(bulk_runs, into);
+    bulk_runs = std::vector< std::string >(1, into);
+  }
+  else
+  {
+    merge_files(bulk_runs, "");
+    bulk_runs.clear();
+  }
+  callback->partial_finished();
+}
+
+
 void Way_Updater::merge_files(const std::vector< std::string >& froms, std::string into)
 {
   Transaction_Collection from_transactions(false, false, db_dir, froms);
@@ -1134,6 +1197,8 @@ void Way_Updater::merge_files(const std::vector< std::string >& froms, std::stri
       (from_transactions, into_transaction, *osm_base_settings().WAY_TAGS_LOCAL);
   ::merge_files< Tag_Index_Global, Tag_Object_Global< Way::Id_Type > >
       (from_transactions, into_transaction, *osm_base_settings().WAY_TAGS_GLOBAL);
+  ::merge_files< Uint64, Parent_Entry >
+      (from_transactions, into_transaction, *osm_base_settings().NODE_WAYS);
   if (meta)
   {
     ::merge_files< Uint31_Index, OSM_Element_Metadata_Skeleton< Way::Id_Type > >
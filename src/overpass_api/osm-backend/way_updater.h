@@ -37,7 +37,9 @@ struct Way_Updater
 {
   Way_Updater(Transaction& transaction, Database_Meta_State::Mode meta);
 
-  Way_Updater(std::string db_dir, Database_Meta_State::Mode meta);
+  // With bulk_import, every flush into an empty database is kept as a sorted run,
+  // and the runs are merged at the end in a single pass.
+  Way_Updater(std::string db_dir, Database_Meta_State::Mode meta, bool bulk_import = false);
 
   void set_id_deleted(Way::Id_Type id, const OSM_Element_Metadata* meta = 0)
   {
@@ -94,6 +96,8 @@ private:
   Transaction* transaction;
   bool external_transaction;
   bool partial_possible;
+  bool bulk_import;
+  std::vector< std::string > bulk_runs;
   std::vector< std::pair< Way::Id_Type, Uint31_Index > > moved_ways;
   std::string db_dir;
 
@@ -109,6 +113,7 @@ private:
   Key_Storage keys;
 
   void merge_files(const std::vector< std::string >& froms, std::string into);
+  void update_bulk_runs(Osm_Backend_Callback* callback, bool partial);
 };
 
 #endif
@@ -487,6 +487,15 @@ void Area_Query_Statement::get_ranges(std::set< Uint31_Index >& area_blocks_req,
 
 void Area_Query_Statement::fill_ranges(Resource_Manager& rman)
 {
+  // The scan covers the whole areas file, hence sibling statements share its result if possible
+  Shared_Ranges_Cache* cache = rman.shared_ranges_cache();
+  std::string key = "area:" + to_string(submitted_id);
+  if (cache && cache->get(key, area_blocks_req))
+  {
+    area_blocks_req_filled = true;
+    return;
+  }
+
   Block_Backend< Uint31_Index, Area_Skeleton > area_locations_db
       (rman.get_area_transaction()->data_index(area_settings().AREAS));
   for (Block_Backend< Uint31_Index, Area_Skeleton >::Flat_Iterator
@@ -501,6 +510,9 @@ void Area_Query_Statement::fill_ranges(Resource_Manager& rman)
     }
   }
   area_blocks_req_filled = true;
+
+  if (cache)
+    cache->put(key, std::vector< std::string >(), area_blocks_req);
 }
 
 
@@ -588,12 +600,12 @@ void Area_Query_Statement::collect_nodes
       loop_count = 0;
     }
 
-    std::map< Area_Skeleton::Id_Type, std::vector< Area_Block > > areas;
+    std::map< Area_Skeleton::Id_Type, std::vector< Decoded_Area_Block > > areas;
     while ((!(area_it == area_blocks_db.discrete_end())) &&
         (area_it.index().val() == current_idx))
     {
       if (binary_search(area_id.begin(), area_id.end(), area_it.object().id))
-	areas[area_it.object().id].push_back(area_it.object());
+	areas[area_it.object().id].push_back(Decoded_Area_Block(current_idx, area_it.object()));
       ++area_it;
     }
 
@@ -613,16 +625,16 @@ void Area_Query_Statement::collect_nodes
             + 91.0)*10000000+0.5);
         int32 ilon(::lon(nodes_it->first.val(), iit->ll_lower)*10000000
             + (::lon(nodes_it->first.val(), iit->ll_lower) > 0 ? 0.5 : -0.5));
-        for (std::map< Area_Skeleton::Id_Type, std::vector< Area_Block > >::const_iterator it = areas.begin();
-	     it != areas.end(); ++it)
+        for (std::map< Area_Skeleton::Id_Type, std::vector< Decoded_Area_Block > >::const_iterator
+            it = areas.begin(); it != areas.end(); ++it)
         {
           int inside = 0;
-          for (std::vector< Area_Block >::const_iterator it2 = it->second.begin(); it2 != it->second.end();
-	       ++it2)
+          for (std::vector< Decoded_Area_Block >::const_iterator it2 = it->second.begin();
+              it2 != it->second.end(); ++it2)
           {
             ++loop_count;
 
-	    int check(Coord_Query_Statement::check_area_block(current_idx, *it2, ilat, ilon));
+	    int check(Coord_Query_Statement::check_area_block(*it2, ilat, ilon));
 	    if (check == Coord_Query_Statement::HIT && add_border)
 	    {
 	      inside = 1;
@@ -872,11 +884,15 @@ void Area_Query_Statement::collect_ways
     }
 
     std::map< Area_Skeleton::Id_Type, std::vector< Area_Block > > areas;
+    std::map< Area_Skeleton::Id_Type, std::vector< Decoded_Area_Block > > decoded_areas;
     while ((!(area_it == area_blocks_db.discrete_end())) &&
         (area_it.index().val() == current_idx))
     {
       if (binary_search(area_id.begin(), area_id.end(), area_it.object().id))
+      {
 	areas[area_it.object().id].push_back(area_it.object());
+	decoded_areas[area_it.object().id].push_back(Decoded_Area_Block(current_idx, area_it.object()));
+      }
       ++area_it;
     }
 
@@ -892,16 +908,16 @@ void Area_Query_Statement::collect_ways
       {
         uint32 ilat = ::ilat(nodes_it->first, iit->first);
         int32 ilon = ::ilon(nodes_it->first, iit->first);
-        for (std::map< Area_Skeleton::Id_Type, std::vector< Area_Block > >::const_iterator it = areas.begin();
-	     it != areas.end(); ++it)
+        for (std::map< Area_Skeleton::Id_Type, std::vector< Decoded_Area_Block > >::const_iterator
+            it = decoded_areas.begin(); it != decoded_areas.end(); ++it)
         {
           int inside = 0;
-          for (std::vector< Area_Block >::const_iterator it2 = it->second.begin(); it2 != it->second.end();
-	       ++it2)
+          for (std::vector< Decoded_Area_Block >::const_iterator it2 = it->second.begin();
+              it2 != it->second.end(); ++it2)
           {
             ++loop_count;
 
-	    int check(Coord_Query_Statement::check_area_block(current_idx, *it2, ilat, ilon));
+	    int check(Coord_Query_Statement::check_area_block(*it2, ilat, ilon));
 	    if (check == Coord_Query_Statement::HIT)
             {
               inside = Coord_Query_Statement::HIT;
@@ -55,6 +55,13 @@ class Area_Query_Statement : public Output_Statement
     static Criterion_Maker criterion_maker;
 
     virtual Query_Constraint* get_query_constraint();
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      if (areas_from_input())
+        inputs.push_back(input);
+      outputs.push_back(get_result_name());
+      return true;
+    }
 
     void get_ranges
       (std::set< Uint31_Index >& area_blocks_req,
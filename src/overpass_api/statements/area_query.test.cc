@@ -16,6 +16,8 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+#include <ctime>
 #include <iostream>
 #include <sstream>
 #include "../../template_db/block_backend.h"
@@ -164,8 +166,114 @@ void comp_sets(Resource_Manager& rman, const std::string& set_1, const std::stri
 }
 
 
+int check_area(uint32 ll_index, const std::vector< Area_Block >& areas,
+    uint32 ilat, int32 ilon)
+{
+  int inside = 0;
+  for (std::vector< Area_Block >::const_iterator it = areas.begin(); it != areas.end(); ++it)
+  {
+    int check(Coord_Query_Statement::check_area_block(ll_index, *it, ilat, ilon));
+    if (check == Coord_Query_Statement::HIT)
+      return 2;
+    inside ^= check;
+  }
+  return inside ? 1 : 0;
+}
+
+
+int check_area(const std::vector< Decoded_Area_Block >& areas, uint32 ilat, int32 ilon)
+{
+  int inside = 0;
+  for (std::vector< Decoded_Area_Block >::const_iterator it = areas.begin(); it != areas.end(); ++it)
+  {
+    int check(Coord_Query_Statement::check_area_block(*it, ilat, ilon));
+    if (check == Coord_Query_Statement::HIT)
+      return 2;
+    inside ^= check;
+  }
+  return inside ? 1 : 0;
+}
+
+
+// Compares the point-in-area test on raw area blocks with the test on pre-decoded area blocks.
+int benchmark_area_blocks()
+{
+  const double center_lat = 51.25;
+  const double center_lon = 7.15;
+  const uint32 ll_index = ll_upper_(center_lat, center_lon) & 0xffffff00;
+  const double radius = 0.0005;
+  const unsigned int num_vertices = 4096;
+  const unsigned int block_size = 16;
+
+  std::vector< uint64 > ring;
+  for (unsigned int i = 0; i <= num_vertices; ++i)
+  {
+    double angle = 2*M_PI*(i % num_vertices)/num_vertices;
+    double lat = center_lat + radius*(1 + 0.3*std::sin(7*angle))*std::sin(angle);
+    double lon = center_lon + radius*(1 + 0.3*std::sin(7*angle))*std::cos(angle);
+    if ((ll_upper_(lat, lon) & 0xffffff00) != ll_index)
+    {
+      std::cout<<"Benchmark polygon exceeds its tile.\n";
+      return 1;
+    }
+    ring.push_back(((uint64)ll_upper_(lat, lon)<<32) | ll_lower(lat, lon));
+  }
+
+  std::vector< Area_Block > areas;
+  std::vector< Decoded_Area_Block > decoded_areas;
+  for (unsigned int i = 0; i + 1 < ring.size(); i += block_size)
+  {
+    std::vector< uint64 > coors(ring.begin() + i,
+        ring.begin() + std::min((std::vector< uint64 >::size_type)(i + block_size + 1), ring.size()));
+    areas.push_back(Area_Block(1u, coors));
+    decoded_areas.push_back(Decoded_Area_Block(ll_index, areas.back()));
+  }
+
+  std::vector< std::pair< uint32, int32 > > points;
+  for (unsigned int i = 0; i < 200; ++i)
+  {
+    for (unsigned int j = 0; j < 200; ++j)
+      points.push_back(std::make_pair(
+          ilat_(center_lat - 1.5*radius + 3*radius*i/200),
+          ilon_(center_lon - 1.5*radius + 3*radius*j/200)));
+  }
+
+  std::vector< int > raw_results;
+  clock_t start = clock();
+  for (std::vector< std::pair< uint32, int32 > >::const_iterator it = points.begin();
+      it != points.end(); ++it)
+    raw_results.push_back(check_area(ll_index, areas, it->first, it->second));
+  clock_t raw_time = clock() - start;
+
+  std::vector< int > decoded_results;
+  start = clock();
+  for (std::vector< std::pair< uint32, int32 > >::const_iterator it = points.begin();
+      it != points.end(); ++it)
+    decoded_results.push_back(check_area(decoded_areas, it->first, it->second));
+  clock_t decoded_time = clock() - start;
+
+  unsigned int inside = 0;
+  for (std::vector< int >::const_iterator it = decoded_results.begin(); it != decoded_results.end(); ++it)
+    inside += (*it != 0);
+
+  std::cout<<points.size()<<" points against "<<areas.size()<<" area blocks, "
+      <<inside<<" inside\n"
+      <<"raw area blocks: "<<double(raw_time)/CLOCKS_PER_SEC<<" s\n"
+      <<"decoded area blocks: "<<double(decoded_time)/CLOCKS_PER_SEC<<" s\n";
+  if (raw_results != decoded_results)
+  {
+    std::cout<<"Results differ.\n";
+    return 1;
+  }
+  return 0;
+}
+
+
 int main(int argc, char* args[])
 {
+  if (argc > 1 && std::string(args[1]) == "benchmark")
+    return benchmark_area_blocks();
+
 //   Great_Circle gc(Point_Double(51.25, 179.), Point_Double(51.5, -179.));
 //   std::cout<<"gc "<<gc.lat_of(179.)<<'\n';
 //   std::cout<<"gc "<<gc.lat_of(179.5)<<'\n';
@@ -79,6 +79,12 @@ class Around_Statement : public Output_Statement
     static Criterion_Maker criterion_maker;
 
     virtual Query_Constraint* get_query_constraint();
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      inputs.push_back(input);
+      outputs.push_back(get_result_name());
+      return true;
+    }
 
     std::string get_source_name() const { return input; }
 
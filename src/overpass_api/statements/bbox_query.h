@@ -53,6 +53,11 @@ class Bbox_Query_Statement : public Output_Statement
     static Criterion_Maker criterion_maker;
 
     virtual Query_Constraint* get_query_constraint();
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      outputs.push_back(get_result_name());
+      return true;
+    }
 
     const Ranges< Uint32_Index >& get_ranges_32();
     const Ranges< Uint31_Index >& get_ranges_31();
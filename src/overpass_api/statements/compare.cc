@@ -74,6 +74,7 @@ void Compare_Statement::execute(Resource_Manager& rman)
     delete set_comparison;
     set_comparison = new Set_Comparison(
         *rman.get_transaction(), *input_set, rman.get_desired_timestamp());
+    set_comparison->spill_lhs_on_pressure(rman, *this);
 
     Set into;
     transfer_output(rman, into);
@@ -100,7 +101,10 @@ void Compare_Statement::execute(Resource_Manager& rman)
       rman.switch_diff_show_from(get_result_name());
 
       for (std::vector< Statement* >::iterator it = substatements.begin(); it != substatements.end(); ++it)
+      {
+        Statement_Profile_Scope profile_scope(rman, **it);
         (*it)->execute(rman);
+      }
 
       rman.pop_stack_frame();
 
@@ -108,7 +112,10 @@ void Compare_Statement::execute(Resource_Manager& rman)
       rman.switch_diff_show_to(get_result_name());
 
       for (std::vector< Statement* >::iterator it = substatements.begin(); it != substatements.end(); ++it)
+      {
+        Statement_Profile_Scope profile_scope(rman, **it);
         (*it)->execute(rman);
+      }
 
       rman.pop_stack_frame();
 
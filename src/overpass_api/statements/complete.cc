@@ -79,7 +79,10 @@ void Complete_Statement::execute(Resource_Manager& rman)
     rman.copy_outward(input, get_result_name());
 
     for (std::vector< Statement* >::iterator it = substatements.begin(); it != substatements.end(); ++it)
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
       (*it)->execute(rman);
+    }
 
     new_elements_found = rman.union_inward(input, input);
   }
@@ -16,6 +16,7 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <iostream>
@@ -87,12 +88,11 @@ Coord_Query_Statement::Coord_Query_Statement
   the coordinates to the southern end of the block. If it is odd, the coordinate
   is inside the area, if not, they are not.
 */
-int Coord_Query_Statement::check_area_block
-    (uint32 ll_index, const Area_Block& area_block,
+int Coord_Query_Statement::check_segment
+    (uint32 last_lat, int32 last_lon, uint32 lat, int32 lon,
      uint32 coord_lat, int32 coord_lon)
 {
-  // An area block is a chain of segments. We consider each
-  // segment individually. This falls into different cases, determined by
+  // We consider each segment individually. This falls into different cases, determined by
   // the relative position of the intersection of the segment and a straight
   // line from north to south through the coordinate to test.
   // (1) If the segment intersects north of the coordinates or doesn't intersect
@@ -104,6 +104,75 @@ int Coord_Query_Statement::check_area_block
   // (4) A special case is if one endpoint is the intersection point. We then toggle
   // only either the western or the eastern side. We are part of the area if in the
   // end the western or eastern side have an odd state.
+  if (last_lon < lon)
+  {
+    if (lon < coord_lon)
+      return 0; // case (1)
+    else if (last_lon > coord_lon)
+      return 0; // case (1)
+    else if (lon == coord_lon)
+    {
+      if (lat < coord_lat)
+        return TOGGLE_WEST; // case (4)
+      else if (lat == coord_lat)
+        return HIT; // case (2)
+      return 0; // case (1)
+    }
+    else if (last_lon == coord_lon)
+    {
+      if (last_lat < coord_lat)
+        return TOGGLE_EAST; // case (4)
+      else if (last_lat == coord_lat)
+        return HIT; // case (2)
+      return 0; // case (1)
+    }
+  }
+  else if (last_lon > lon)
+  {
+    if (lon > coord_lon)
+      return 0; // case (1)
+    else if (last_lon < coord_lon)
+      return 0; // case (1)
+    else if (lon == coord_lon)
+    {
+      if (lat < coord_lat)
+        return TOGGLE_EAST; // case (4)
+      else if (lat == coord_lat)
+        return HIT; // case (2)
+      return 0; // case (1)
+    }
+    else if (last_lon == coord_lon)
+    {
+      if (last_lat < coord_lat)
+        return TOGGLE_WEST; // case (4)
+      else if (last_lat == coord_lat)
+        return HIT; // case (2)
+      return 0; // case (1)
+    }
+  }
+  else // last_lon == lon
+  {
+    if (lon == coord_lon &&
+        ((last_lat <= coord_lat && coord_lat <= lat) || (lat <= coord_lat && coord_lat <= last_lat)))
+      return HIT; // case (2)
+    return 0; // else: case (1)
+  }
+
+  uint32 intersect_lat = lat +
+      ((int64)coord_lon - lon)*((int64)last_lat - lat)/((int64)last_lon - lon);
+  if (coord_lat > intersect_lat)
+    return (TOGGLE_EAST | TOGGLE_WEST); // case (3)
+  else if (coord_lat == intersect_lat)
+    return HIT; // case (2)
+  return 0; // case (1)
+}
+
+
+int Coord_Query_Statement::check_area_block
+    (uint32 ll_index, const Area_Block& area_block,
+     uint32 coord_lat, int32 coord_lon)
+{
+  // An area block is a chain of segments.
   int state = 0;
   std::vector< uint64 >::const_iterator it(area_block.coors.begin());
   uint32 lat = ::ilat(ll_index | (((*it)>>32)&0xff), (*it & 0xffffffff));
@@ -115,82 +184,111 @@ int Coord_Query_Statement::check_area_block
     lon = ::ilon(ll_index | (((*it)>>32)&0xff), (*it & 0xffffffff));
     lat = ::ilat(ll_index | (((*it)>>32)&0xff), (*it & 0xffffffff));
 
-    if (last_lon < lon)
-    {
-      if (lon < coord_lon)
-	continue; // case (1)
-      else if (last_lon > coord_lon)
-	continue; // case (1)
-      else if (lon == coord_lon)
-      {
-	if (lat < coord_lat)
-	  state ^= TOGGLE_WEST; // case (4)
-	else if (lat == coord_lat)
-	  return HIT; // case (2)
-	// else: case (1)
-	continue;
-      }
-      else if (last_lon == coord_lon)
-      {
-	if (last_lat < coord_lat)
-	  state ^= TOGGLE_EAST; // case (4)
-	else if (last_lat == coord_lat)
-	  return HIT; // case (2)
-	// else: case (1)
-	continue;
-      }
-    }
-    else if (last_lon > lon)
-    {
-      if (lon > coord_lon)
-	continue; // case (1)
-      else if (last_lon < coord_lon)
-	continue; // case (1)
-      else if (lon == coord_lon)
-      {
-	if (lat < coord_lat)
-	  state ^= TOGGLE_EAST; // case (4)
-	else if (lat == coord_lat)
-	  return HIT; // case (2)
-	// else: case (1)
-	continue;
-      }
-      else if (last_lon == coord_lon)
-      {
-	if (last_lat < coord_lat)
-	  state ^= TOGGLE_WEST; // case (4)
-	else if (last_lat == coord_lat)
-	  return HIT; // case (2)
-	// else: case (1)
-	continue;
-      }
-    }
-    else // last_lon == lon
-    {
-      if (lon == coord_lon &&
-          ((last_lat <= coord_lat && coord_lat <= lat) || (lat <= coord_lat && coord_lat <= last_lat)))
-        return HIT; // case (2)
-      continue; // else: case (1)
-    }
+    int check = check_segment(last_lat, last_lon, lat, lon, coord_lat, coord_lon);
+    if (check == HIT)
+      return HIT;
+    state ^= check;
+  }
+  return state;
+}
 
-    uint32 intersect_lat = lat +
-        ((int64)coord_lon - lon)*((int64)last_lat - lat)/((int64)last_lon - lon);
-    if (coord_lat > intersect_lat)
-      state ^= (TOGGLE_EAST | TOGGLE_WEST); // case (3)
-    else if (coord_lat == intersect_lat)
-      return HIT; // case (2)
-    // else: case (1)
+
+Decoded_Area_Block::Decoded_Area_Block(uint32 ll_index, const Area_Block& area_block)
+    : id(area_block.id), min_lat(0xffffffffu), min_lon(0x7fffffff), max_lon(-0x7fffffff-1)
+{
+  coords.reserve(area_block.coors.size());
+  for (std::vector< uint64 >::const_iterator it = area_block.coors.begin(); it != area_block.coors.end(); ++it)
+  {
+    uint32 lat = ::ilat(ll_index | (((*it)>>32)&0xff), (*it & 0xffffffff));
+    int32 lon = ::ilon(ll_index | (((*it)>>32)&0xff), (*it & 0xffffffff));
+    coords.push_back(std::make_pair(lat, lon));
+    min_lat = std::min(min_lat, lat);
+    min_lon = std::min(min_lon, lon);
+    max_lon = std::max(max_lon, lon);
+  }
+}
+
+
+int Coord_Query_Statement::check_area_block
+    (const Decoded_Area_Block& area_block, uint32 coord_lat, int32 coord_lon)
+{
+  // No segment can intersect the line from the coordinate to the south
+  // if the coordinate is outside the longitude range or south of the block.
+  if (coord_lon < area_block.min_lon || area_block.max_lon < coord_lon || coord_lat < area_block.min_lat)
+    return 0;
+
+  int state = 0;
+  std::vector< std::pair< uint32, int32 > >::const_iterator it = area_block.coords.begin();
+  if (it == area_block.coords.end())
+    return 0;
+  std::vector< std::pair< uint32, int32 > >::const_iterator last_it = it;
+  while (++it != area_block.coords.end())
+  {
+    int check = check_segment(last_it->first, last_it->second, it->first, it->second, coord_lat, coord_lon);
+    if (check == HIT)
+      return HIT;
+    state ^= check;
+    last_it = it;
   }
   return state;
 }
 
 
+// The coordinates are kept as integer longitude and latitude, such that they can be sorted by longitude
 void register_coord(double lat, double lon,
-    std::set< Uint31_Index >& req, std::map< Uint31_Index, std::vector< std::pair< double, double > > >& coord_per_req)
+    std::set< Uint31_Index >& req, std::map< Uint31_Index, std::vector< std::pair< int32, uint32 > > >& coord_per_req)
 {
   Uint31_Index idx = Uint31_Index(::ll_upper_(lat, lon) & 0xffffff00);
   req.insert(idx);
-  coord_per_req[idx].push_back(std::make_pair(lat, lon));
+  coord_per_req[idx].push_back(std::make_pair(
+      int32(lon*10000000 + (lon > 0 ? 0.5 : -0.5)), uint32((lat + 91.0)*10000000+0.5)));
+}
+
+
+/* Tests all coordinates of a tile against one area block. Only the coordinates within the longitude extent
+ * of the block can be affected, hence the sorted coordinates need to be tested only on that slice.
+ * Toggles are collected per area and coordinate and evaluated once the tile is complete. */
+void check_coords_against_block(
+    const std::vector< std::pair< int32, uint32 > >& coords, const Decoded_Area_Block& block,
+    std::vector< std::pair< std::pair< Area::Id_Type, uint32 >, int > >& toggles,
+    std::set< Area::Id_Type >& areas_found)
+{
+  std::vector< std::pair< int32, uint32 > >::const_iterator begin =
+      std::lower_bound(coords.begin(), coords.end(), std::make_pair(block.min_lon, 0u));
+  std::vector< std::pair< int32, uint32 > >::const_iterator end =
+      std::upper_bound(begin, coords.end(), std::make_pair(block.max_lon, 0xffffffffu));
+  for (std::vector< std::pair< int32, uint32 > >::const_iterator it = begin; it != end; ++it)
+  {
+    int check = Coord_Query_Statement::check_area_block(block, it->second, it->first);
+    if (check == Coord_Query_Statement::HIT)
+    {
+      // The area is found, hence its other toggles do not matter anymore
+      areas_found.insert(block.id);
+      return;
+    }
+    else if (check != 0)
+      toggles.push_back(std::make_pair(std::make_pair(block.id, uint32(it - coords.begin())), check));
+  }
+}
+
+
+// An area contains a coordinate if the toggles of its blocks in the tile add up to an odd state
+void flush_toggles(
+    std::vector< std::pair< std::pair< Area::Id_Type, uint32 >, int > >& toggles,
+    std::set< Area::Id_Type >& areas_found)
+{
+  std::sort(toggles.begin(), toggles.end());
+  std::vector< std::pair< std::pair< Area::Id_Type, uint32 >, int > >::const_iterator it = toggles.begin();
+  while (it != toggles.end())
+  {
+    std::pair< Area::Id_Type, uint32 > key = it->first;
+    int state = 0;
+    for (; it != toggles.end() && it->first == key; ++it)
+      state ^= it->second;
+    if (state != 0)
+      areas_found.insert(key.first);
+  }
+  toggles.clear();
 }
 
 
@@ -211,7 +309,7 @@ void Coord_Query_Statement::execute(Resource_Manager& rman)
 
   std::set< Uint31_Index > req;
   std::set< Uint31_Index > node_idxs;
-  std::map< Uint31_Index, std::vector< std::pair< double, double > > > coord_per_req;
+  std::map< Uint31_Index, std::vector< std::pair< int32, uint32 > > > coord_per_req;
 
   const Set* input_set = 0;
   if (lat != 100.0)
@@ -247,10 +345,17 @@ void Coord_Query_Statement::execute(Resource_Manager& rman)
     }
   }
 
-  std::map< std::pair< double, double >, std::map< Area::Id_Type, int > > areas_inside;
+  for (std::map< Uint31_Index, std::vector< std::pair< int32, uint32 > > >::iterator it = coord_per_req.begin();
+      it != coord_per_req.end(); ++it)
+  {
+    std::sort(it->second.begin(), it->second.end());
+    it->second.erase(std::unique(it->second.begin(), it->second.end()), it->second.end());
+  }
+
   std::set< Area::Id_Type > areas_found;
+  std::vector< std::pair< std::pair< Area::Id_Type, uint32 >, int > > toggles;
 
-  std::map< Uint31_Index, std::vector< std::pair< double, double > > >::const_iterator coord_block_it = coord_per_req.begin();
+  std::map< Uint31_Index, std::vector< std::pair< int32, uint32 > > >::const_iterator coord_block_it = coord_per_req.begin();
   Uint31_Index last_idx = req.empty() ? Uint31_Index(0u) : *req.begin();
 
   Block_Backend< Uint31_Index, Area_Block, std::set< Uint31_Index >::const_iterator > area_blocks_db
@@ -262,18 +367,7 @@ void Coord_Query_Statement::execute(Resource_Manager& rman)
     if (!(it.index() == last_idx))
     {
       last_idx = it.index();
-
-      for (std::map< std::pair< double, double >, std::map< Area::Id_Type, int > >::const_iterator
-	  inside_it = areas_inside.begin(); inside_it != areas_inside.end(); ++inside_it)
-      {
-	for (std::map< Area::Id_Type, int >::const_iterator inside_it2 = inside_it->second.begin();
-	     inside_it2 != inside_it->second.end(); ++inside_it2)
-	{
-	  if (inside_it2->second != 0)
-	    areas_found.insert(inside_it2->first);
-	}
-      }
-      areas_inside.clear();
+      flush_toggles(toggles, areas_found);
 
       while (coord_block_it != coord_per_req.end() && coord_block_it->first < it.index())
         ++coord_block_it;
@@ -281,37 +375,11 @@ void Coord_Query_Statement::execute(Resource_Manager& rman)
         break;
     }
 
-    for (std::vector< std::pair< double, double > >::const_iterator coord_it = coord_block_it->second.begin();
-	 coord_it != coord_block_it->second.end(); ++coord_it)
-    {
-      uint32 ilat((coord_it->first + 91.0)*10000000+0.5);
-      int32 ilon(coord_it->second*10000000 + (coord_it->second > 0 ? 0.5 : -0.5));
-
-      int check = check_area_block(it.index().val(), it.object(), ilat, ilon);
-      if (check == HIT)
-        areas_found.insert(it.object().id);
-      else if (check != 0)
-      {
-        std::map< Area::Id_Type, int >::iterator it2 = areas_inside[*coord_it].find(it.object().id);
-        if (it2 != areas_inside[*coord_it].end())
-	  it2->second ^= check;
-        else
-	  areas_inside[*coord_it].insert(std::make_pair(it.object().id, check));
-      }
-    }
-  }
-
-  for (std::map< std::pair< double, double >, std::map< Area::Id_Type, int > >::const_iterator
-      inside_it = areas_inside.begin(); inside_it != areas_inside.end(); ++inside_it)
-  {
-    for (std::map< Area::Id_Type, int >::const_iterator inside_it2 = inside_it->second.begin();
-        inside_it2 != inside_it->second.end(); ++inside_it2)
-    {
-      if (inside_it2->second != 0)
-        areas_found.insert(inside_it2->first);
-    }
+    if (areas_found.find(it.object().id) == areas_found.end())
+      check_coords_against_block(coord_block_it->second, Decoded_Area_Block(it.index().val(), it.object()),
+          toggles, areas_found);
   }
-  areas_inside.clear();
+  flush_toggles(toggles, areas_found);
 
   Set into;
   
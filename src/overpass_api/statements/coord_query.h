@@ -26,6 +26,21 @@
 #include "statement.h"
 
 
+/* An Area_Block with the coordinates of its vertices decoded for a fixed quadtile index.
+ * Point-in-area tests evaluate many coordinates of the same tile against the same blocks.
+ * Decoding the blocks once per tile and rejecting them by their extent saves most of the work. */
+struct Decoded_Area_Block
+{
+  Decoded_Area_Block(uint32 ll_index, const Area_Block& area_block);
+
+  Area_Block::Id_Type id;
+  std::vector< std::pair< uint32, int32 > > coords;
+  uint32 min_lat;
+  int32 min_lon;
+  int32 max_lon;
+};
+
+
 class Coord_Query_Statement : public Output_Statement
 {
   public:
@@ -36,6 +51,7 @@ class Coord_Query_Statement : public Output_Statement
     virtual ~Coord_Query_Statement() {}
     static Generic_Statement_Maker< Coord_Query_Statement > statement_maker;
 
+    // Returns HIT if the coordinate is on the segment, otherwise the toggle bits of the segment
     static int check_segment
         (uint32 a_lat, int32 a_lon, uint32 b_lat, int32 b_lon,
          uint32 coord_lat, int32 coord_lon);
@@ -44,6 +60,8 @@ class Coord_Query_Statement : public Output_Statement
     static int check_area_block
         (uint32 ll_index, const Area_Block& area_block,
 	 uint32 coord_lat, int32 coord_lon);
+    static int check_area_block
+        (const Decoded_Area_Block& area_block, uint32 coord_lat, int32 coord_lon);
 
     // Used as bitmasks.
     const static int HIT = 1;
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "../data/abstract_processing.h"
+#include "../data/spilled_set.h"
 #include "difference.h"
 
 
@@ -73,15 +74,43 @@ void Difference_Statement::execute(Resource_Manager& rman)
   rman.push_stack_frame();
 
   std::vector< Statement* >::iterator it = substatements.begin();
-  (*it)->execute(rman);
+  {
+    Statement_Profile_Scope profile_scope(rman, **it);
+    (*it)->execute(rman);
+  }
 
   rman.copy_inward((*it)->get_result_name(), get_result_name());
 
   ++it;
   if (it != substatements.end())
   {
-    (*it)->execute(rman);
+    // The first operand can wait on disk while the second one is computed,
+    // unless the second substatement reads the set that holds the first operand
+    Spilled_Set spilled(rman.get_transaction()->get_db_dir());
+    std::vector< std::string > inputs;
+    std::vector< std::string > outputs;
+    if ((*it)->get_set_names(inputs, outputs)
+        && std::find(inputs.begin(), inputs.end(), get_result_name()) == inputs.end())
+    {
+      Set lhs;
+      rman.swap_inward(get_result_name(), lhs);
+      spilled.spill_on_pressure(rman, *this, lhs);
+      rman.swap_inward(get_result_name(), lhs);
+    }
+
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
+      (*it)->execute(rman);
+    }
     rman.substract_from_inward((*it)->get_result_name(), get_result_name());
+
+    if (!spilled.empty())
+    {
+      Set lhs;
+      rman.swap_inward(get_result_name(), lhs);
+      spilled.merge_into(lhs, rman.get_set((*it)->get_result_name()));
+      rman.swap_inward(get_result_name(), lhs);
+    }
   }
 
   rman.move_all_inward_except(get_result_name());
@@ -256,7 +256,10 @@ void For_Statement::execute(Resource_Manager& rman)
 
     for (std::vector< Statement* >::iterator it = substatements.begin();
         it != substatements.end(); ++it)
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
       (*it)->execute(rman);
+    }
   }
 
   rman.move_all_inward_except(get_result_name());
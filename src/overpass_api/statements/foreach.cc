@@ -96,7 +96,10 @@ void loop_over_elements(const std::map< Index, std::vector< Object > >& source,
 
       for (std::vector< Statement* >::iterator it = substatements.begin();
           it != substatements.end(); ++it)
-	(*it)->execute(rman);
+      {
+        Statement_Profile_Scope profile_scope(rman, **it);
+        (*it)->execute(rman);
+      }
     }
   }
 }
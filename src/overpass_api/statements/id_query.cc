@@ -389,8 +389,12 @@ void get_elements(const std::vector< uint64 >& refs, Statement* stmt, Resource_M
   std::vector< Index > req = get_indexes_< Index, Skeleton >(ids, rman);
 
   if (rman.get_desired_timestamp() == NOW)
+  {
+    Block_Id_Filter filter(ids.begin(), ids.end());
     collect_items_discrete(stmt, rman, *current_skeleton_file_properties< Skeleton >(), req,
-        Id_Predicate< Skeleton >(ids), current_result);
+        Id_Predicate< Skeleton >(ids), current_result,
+        ids.size() <= Block_Id_Filter::MAX_IDS ? &filter : 0);
+  }
   else
   {
     collect_items_discrete_by_timestamp(stmt, rman, req,
@@ -75,12 +75,18 @@ void If_Statement::execute(Resource_Manager& rman)
   if (criterion && evals_to_true(*criterion, *this, rman))
   {
     for (std::vector< Statement* >::iterator it = substatements.begin(); it != substatements.end(); ++it)
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
       (*it)->execute(rman);
+    }
   }
   else
   {
     for (std::vector< Statement* >::iterator it = else_statements.begin(); it != else_statements.end(); ++it)
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
       (*it)->execute(rman);
+    }
   }
 
   rman.health_check(*this);
@@ -39,6 +39,12 @@ class Item_Statement : public Output_Statement
     static Generic_Statement_Maker< Item_Statement > statement_maker;
 
     virtual Query_Constraint* get_query_constraint();
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      inputs.push_back(input);
+      outputs.push_back(get_result_name());
+      return true;
+    }
 
     virtual std::string dump_xml(const std::string& indent) const
     {
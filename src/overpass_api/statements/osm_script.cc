@@ -16,8 +16,10 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 #include "../core/settings.h"
@@ -74,6 +76,7 @@ Osm_Script_Statement::Osm_Script_Statement
   attributes["date"] = "";
   attributes["from"] = "";
   attributes["augmented"] = "";
+  attributes["profile"] = "";
 
   eval_attributes_array(get_name(), attributes, input_attributes);
 
@@ -197,6 +200,11 @@ Osm_Script_Statement::Osm_Script_Statement
       add_static_error("The selected output format does not support the diff or adiff mode.");
   }
 
+  profile = attributes["profile"];
+  if (profile != "" && profile != "yes" && profile != "log")
+    add_static_error("For the attribute \"profile\" of the element \"osm-script\""
+        " the only allowed values are an empty value, \"yes\", or \"log\".");
+
   if (attributes["augmented"] != "")
   {
     if (attributes["augmented"] == "deletions" && attributes["from"] != "")
@@ -231,27 +239,131 @@ void Osm_Script_Statement::add_statement(Statement* statement, std::string text)
 }
 
 
+/* For each statement, the position of the last earlier statement that may write one of its input sets,
+ * or -1 if there is none. A statement that cannot tell its sets depends on and feeds all others. */
+std::vector< int > last_feeding_statements(const std::vector< Statement* >& statements)
+{
+  std::vector< int > result;
+  std::map< std::string, int > last_writer;
+  int barrier = -1;
+
+  for (int i = 0; i < (int)statements.size(); ++i)
+  {
+    std::vector< std::string > inputs;
+    std::vector< std::string > outputs;
+    if (!statements[i]->get_set_names(inputs, outputs))
+    {
+      result.push_back(i - 1);
+      barrier = i;
+      last_writer.clear();
+      continue;
+    }
+
+    int feeding = barrier;
+    for (std::vector< std::string >::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+    {
+      std::map< std::string, int >::const_iterator it_writer = last_writer.find(*it);
+      if (it_writer != last_writer.end())
+        feeding = std::max(feeding, it_writer->second);
+    }
+    result.push_back(feeding);
+
+    for (std::vector< std::string >::const_iterator it = outputs.begin(); it != outputs.end(); ++it)
+      last_writer[*it] = i;
+  }
+
+  return result;
+}
+
+
+/* The statements are executed strictly in script order, such that results, output and resource
+ * accounting stay exactly as they are. But as soon as all statements feeding a later statement
+ * have run, that statement can announce its reads to the kernel. Then the I/O of independent
+ * statements overlaps with the execution of the statements before them. */
+void execute_in_order(
+    const std::vector< Statement* >& statements, const std::vector< int >& feeding, Resource_Manager& rman)
+{
+  const int PREFETCH_AHEAD = 8;
+
+  std::vector< bool > prefetched(statements.size(), false);
+  for (int i = 0; i < (int)statements.size(); ++i)
+  {
+    for (int j = i + 1; j < (int)statements.size() && j <= i + PREFETCH_AHEAD; ++j)
+    {
+      if (!prefetched[j] && feeding[j] < i)
+      {
+        statements[j]->prefetch(rman);
+        prefetched[j] = true;
+      }
+    }
+
+    Statement_Profile_Scope profile_scope(rman, *statements[i]);
+    statements[i]->execute(rman);
+  }
+}
+
+
 void Osm_Script_Statement::execute(Resource_Manager& rman)
 {
   rman.set_limits(max_allowed_time, max_allowed_space);
   rman.get_global_settings().trigger_print_bounds();
+  if (profile != "")
+    rman.enable_profiling();
 
-  if (comparison_timestamp > 0)
   {
-    rman.start_diff(comparison_timestamp, desired_timestamp);
+    Statement_Profile_Scope profile_scope(rman, *this);
+    std::vector< int > feeding = last_feeding_statements(substatements);
+
+    if (comparison_timestamp > 0)
+    {
+      rman.start_diff(comparison_timestamp, desired_timestamp);
+
+      execute_in_order(substatements, feeding, rman);
+
+      rman.switch_diff_rhs(add_deletion_information);
+    }
 
-    for (std::vector< Statement* >::iterator it(substatements.begin());
-        it != substatements.end(); ++it)
-      (*it)->execute(rman);
+    execute_in_order(substatements, feeding, rman);
 
-    rman.switch_diff_rhs(add_deletion_information);
+    if (rman.area_updater())
+      rman.area_updater()->flush();
+    rman.health_check(*this);
   }
 
-  for (std::vector< Statement* >::iterator it(substatements.begin());
-      it != substatements.end(); ++it)
-    (*it)->execute(rman);
+  if (profile != "")
+    report_profiles(rman);
+}
+
+
+void Osm_Script_Statement::report_profiles(Resource_Manager& rman) const
+{
+  std::ostringstream out;
+  const std::vector< Statement_Profile >& profiles = rman.statement_profiles();
+  for (std::vector< Statement_Profile >::const_iterator it = profiles.begin(); it != profiles.end(); ++it)
+  {
+    out<<"profile: line "<<it->line_number<<" depth "<<it->depth<<" stmt "<<it->stmt_name
+        <<" executions "<<it->executions<<" wall_ms "<<it->wall_time<<" cpu_ms "<<it->cpu_time<<" peak_size "<<it->peak_size;
+    for (std::map< std::string, Block_Read_Statistics >::const_iterator it_file = it->reads.begin();
+        it_file != it->reads.end(); ++it_file)
+    {
+      std::string::size_type pos = it_file->first.find_last_of('/');
+      out<<" file "<<(pos == std::string::npos ? it_file->first : it_file->first.substr(pos+1))
+          <<" blocks "<<it_file->second.blocks_read
+          <<" decompressed "<<it_file->second.blocks_decompressed
+          <<" bytes_read "<<it_file->second.bytes_read
+          <<" bytes_inflated "<<it_file->second.bytes_inflated;
+    }
+    out<<'\n';
+  }
 
-  if (rman.area_updater())
-    rman.area_updater()->flush();
-  rman.health_check(*this);
+  if (profile == "log")
+  {
+    Logger logger(rman.get_transaction()->get_db_dir());
+    std::istringstream in(out.str());
+    std::string line;
+    while (std::getline(in, line))
+      logger.annotated_log(line);
+  }
+  else if (rman.get_global_settings().get_output_handler())
+    rman.get_global_settings().get_output_handler()->display_remark(out.str());
 }
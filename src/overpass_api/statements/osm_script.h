@@ -53,7 +53,10 @@ class Osm_Script_Statement : public Statement
     bool add_deletion_information;
     uint32 max_allowed_time;
     uint64 max_allowed_space;
+    std::string profile;
     Statement::Factory* factory;
+
+    void report_profiles(Resource_Manager& rman) const;
 };
 
 #endif
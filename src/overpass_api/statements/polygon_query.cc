@@ -351,13 +351,13 @@ void Polygon_Query_Statement::collect_nodes(std::map< Uint32_Index, std::vector<
   {
     current_idx = area_it->ll_upper_;
 
-    std::vector< Area_Block > areas;
+    std::vector< Decoded_Area_Block > areas;
     while (area_it != segments.end() && area_it->ll_upper_ == current_idx)
     {
       Area_Block block;
       block.coors.push_back(area_it->ll_lower_a);
       block.coors.push_back(area_it->ll_lower_b);
-      areas.push_back(block);
+      areas.push_back(Decoded_Area_Block(current_idx, block));
       ++area_it;
     }
 
@@ -379,10 +379,10 @@ void Polygon_Query_Statement::collect_nodes(std::map< Uint32_Index, std::vector<
             + (::lon(nodes_it->first.val(), iit->ll_lower) > 0 ? 0.5 : -0.5));
 
         int inside = 0;
-        for (std::vector< Area_Block >::const_iterator it = areas.begin();
+        for (std::vector< Decoded_Area_Block >::const_iterator it = areas.begin();
 	     it != areas.end(); ++it)
         {
-	  int check(Coord_Query_Statement::check_area_block(current_idx, *it, ilat, ilon));
+	  int check(Coord_Query_Statement::check_area_block(*it, ilat, ilon));
 	  if (check == Coord_Query_Statement::HIT && add_border)
 	  {
 	    inside = 1;
@@ -443,12 +443,14 @@ void Polygon_Query_Statement::collect_ways
     current_idx = area_it->ll_upper_;
 
     std::vector< Area_Block > areas;
+    std::vector< Decoded_Area_Block > decoded_areas;
     while (area_it != segments.end() && area_it->ll_upper_ == current_idx)
     {
       Area_Block block;
       block.coors.push_back(area_it->ll_lower_a);
       block.coors.push_back(area_it->ll_lower_b);
       areas.push_back(block);
+      decoded_areas.push_back(Decoded_Area_Block(current_idx, block));
       ++area_it;
     }
 
@@ -466,10 +468,10 @@ void Polygon_Query_Statement::collect_ways
         int32 ilon = ::ilon(nodes_it->first, iit->first);
 
         int inside = 0;
-        for (std::vector< Area_Block >::const_iterator it2 = areas.begin(); it2 != areas.end();
-             ++it2)
+        for (std::vector< Decoded_Area_Block >::const_iterator it2 = decoded_areas.begin();
+             it2 != decoded_areas.end(); ++it2)
         {
-          int check(Coord_Query_Statement::check_area_block(current_idx, *it2, ilat, ilon));
+          int check(Coord_Query_Statement::check_area_block(*it2, ilat, ilon));
           if (check == Coord_Query_Statement::HIT)
           {
             inside = Coord_Query_Statement::HIT;
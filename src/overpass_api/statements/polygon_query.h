@@ -55,6 +55,11 @@ class Polygon_Query_Statement : public Output_Statement
     static Criterion_Maker criterion_maker;
 
     virtual Query_Constraint* get_query_constraint();
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      outputs.push_back(get_result_name());
+      return true;
+    }
 
     Ranges< Uint32_Index > calc_ranges();
 
@@ -937,6 +937,7 @@ void Print_Statement::execute_comparison(Resource_Manager& rman)
     delete collection_print_target;
     collection_print_target = new Set_Comparison(
         *rman.get_transaction(), *input_set, rman.get_desired_timestamp());
+    collection_print_target->spill_lhs_on_pressure(rman, *this);
   }
   else
   {
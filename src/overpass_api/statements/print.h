@@ -79,6 +79,11 @@ class Print_Statement : public Statement
     virtual std::string get_name() const { return "print"; }
     virtual std::string get_result_name() const { return ""; }
     virtual void execute(Resource_Manager& rman);
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    {
+      inputs.push_back(input);
+      return true;
+    }
     virtual ~Print_Statement();
 
     static Generic_Statement_Maker< Print_Statement > statement_maker;
@@ -87,6 +87,7 @@ Query_Statement::Query_Statement
   {
     global_bbox_statement = new Bbox_Query_Statement(global_settings.get_global_bbox_limitation());
     constraints.push_back(global_bbox_statement->get_query_constraint());
+    constraint_sources.push_back(0);
   }
 }
 
@@ -142,6 +143,7 @@ void Query_Statement::add_statement(Statement* statement, std::string text)
   if (constraint)
   {
     constraints.push_back(constraint);
+    constraint_sources.push_back(statement);
     substatements.push_back(statement);
   }
   else
@@ -488,7 +490,10 @@ void Query_Statement::filter_by_tags
 
   Block_Backend< Tag_Index_Local, typename TObject::Id_Type > items_db
       (transaction.data_index(&file_prop));
-  auto tag_it = items_db.range_begin(ranges);
+  // Blocks without any of the keys cannot change the result, but key regexes may match any key
+  Tag_Key_Filter key_filter(key_union.begin(), key_union.end());
+  auto tag_it = timestamp == NOW && regkey_regexes.empty() && !key_union.empty()
+      ? items_db.range_begin(ranges, key_filter) : items_db.range_begin(ranges);
 
   if (timestamp == NOW)
   {
@@ -541,7 +546,9 @@ void Query_Statement::filter_by_tags
   result.clear();
   attic_result.clear();
   coarse_count = 0;
-  auto ntag_it = items_db.range_begin(ranges);
+  Tag_Key_Filter nkey_filter(nkey_union.begin(), nkey_union.end());
+  auto ntag_it = timestamp == NOW
+      ? items_db.range_begin(ranges, nkey_filter) : items_db.range_begin(ranges);
 
   if (timestamp == NOW)
   {
@@ -615,7 +622,9 @@ void Query_Statement::filter_by_tags
 
   Block_Backend< Tag_Index_Local, typename TObject::Id_Type > items_db
       (transaction.data_index(&file_prop));
-  auto tag_it = items_db.range_begin(ranges);
+  Tag_Key_Filter key_filter(key_union.begin(), key_union.end());
+  auto tag_it = regkey_regexes.empty() && !key_union.empty()
+      ? items_db.range_begin(ranges, key_filter) : items_db.range_begin(ranges);
 
   typename std::map< TIndex, std::vector< TObject > >::const_iterator item_it
       = items.begin();
@@ -665,7 +674,8 @@ void Query_Statement::filter_by_tags
   result.clear();
   attic_result.clear();
   coarse_count = 0;
-  auto ntag_it = items_db.range_begin(ranges);
+  Tag_Key_Filter nkey_filter(nkey_union.begin(), nkey_union.end());
+  auto ntag_it = items_db.range_begin(ranges, nkey_filter);
   item_it = items.begin();
 
   {
@@ -917,6 +927,148 @@ void filter_elems_for_closed_ways(Set& arg)
 }
 
 
+const uint64 MAX_PREFETCH_BYTES = 16*1024*1024;
+
+
+/* The element types are collected one after another. Before the first pass starts, we let the kernel
+ * read ahead the blocks of the later passes such that their I/O overlaps with the earlier passes. */
+template< typename Index, typename Skeleton >
+void prefetch_skeletons(const Ranges< Index >& ranges, uint64 timestamp, Resource_Manager& rman)
+{
+  if (ranges.empty() || ranges.is_global())
+    return;
+
+  Block_Backend< Index, Skeleton > current_db(
+      rman.get_transaction()->data_index(current_skeleton_file_properties< Skeleton >()));
+  current_db.prefetch(ranges, MAX_PREFETCH_BYTES);
+
+  if (timestamp != NOW)
+  {
+    Block_Backend< Index, Attic< typename Skeleton::Delta > > attic_db(
+        rman.get_transaction()->data_index(attic_skeleton_file_properties< Skeleton >()));
+    attic_db.prefetch(ranges, MAX_PREFETCH_BYTES);
+  }
+}
+
+
+template< typename Skeleton >
+void prefetch_global_tags(
+    const std::vector< std::pair< std::string, std::string > >& key_values, Resource_Manager& rman)
+{
+  Block_Backend< Tag_Index_Global, Tag_Object_Global< typename Skeleton::Id_Type > > tags_db(
+      rman.get_transaction()->data_index(current_global_tags_file_properties< Skeleton >()));
+  for (std::vector< std::pair< std::string, std::string > >::const_iterator it = key_values.begin();
+      it != key_values.end(); ++it)
+    tags_db.prefetch(get_kv_req(it->first, it->second), MAX_PREFETCH_BYTES);
+}
+
+
+void get_constraint_ranges(
+    Query_Constraint& constraint, int type, Resource_Manager& rman, Ranges< Uint32_Index >& ranges)
+{
+  ranges = constraint.get_node_ranges(rman);
+}
+
+
+void get_constraint_ranges(
+    Query_Constraint& constraint, int type, Resource_Manager& rman, Ranges< Uint31_Index >& ranges)
+{
+  if (type == QUERY_WAY)
+    ranges = constraint.get_way_ranges(rman);
+  else
+    ranges = constraint.get_relation_ranges(rman);
+}
+
+
+/* Within a union, sibling queries often repeat the same filter for different types.
+ * The ranges of such a filter are then computed once and taken from the shared cache.
+ * Filters that cannot tell their input sets are always evaluated on their own. */
+template< typename Index >
+void Query_Statement::intersect_constraint_ranges(int type, Ranges< Index >& ranges, Resource_Manager& rman)
+{
+  Shared_Ranges_Cache* cache = rman.shared_ranges_cache();
+  for (uint i = 0; i < constraints.size(); ++i)
+  {
+    Ranges< Index > constraint_ranges;
+    std::vector< std::string > inputs;
+    std::vector< std::string > outputs;
+    if (cache && constraint_sources[i] && constraint_sources[i]->get_set_names(inputs, outputs))
+    {
+      std::string key = to_string(type) + constraint_sources[i]->get_name()
+          + constraint_sources[i]->dump_ql_in_query("")
+          + "@" + ::to_string(rman.get_desired_timestamp());
+      if (!cache->get(key, constraint_ranges))
+      {
+        get_constraint_ranges(*constraints[i], type, rman, constraint_ranges);
+        cache->put(key, inputs, constraint_ranges);
+      }
+    }
+    else
+      get_constraint_ranges(*constraints[i], type, rman, constraint_ranges);
+
+    ranges.intersect(constraint_ranges).swap(ranges);
+  }
+}
+
+
+bool Query_Statement::get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+{
+  // The filters are never executed on their own, hence only their inputs matter
+  std::vector< std::string > filter_outputs;
+  for (std::vector< Statement* >::const_iterator it = substatements.begin(); it != substatements.end(); ++it)
+  {
+    if (!(*it)->get_set_names(inputs, filter_outputs))
+      return false;
+  }
+  outputs.push_back(get_result_name());
+  return true;
+}
+
+
+/* Filters that depend on input sets may need substantial work to compute their ranges.
+ * Thus we prefetch only for queries whose filters are given by the statement itself. */
+void Query_Statement::prefetch(Resource_Manager& rman)
+{
+  std::vector< std::string > inputs;
+  std::vector< std::string > outputs;
+  if (!get_set_names(inputs, outputs) || !inputs.empty())
+    return;
+
+  uint64 timestamp = rman.get_desired_timestamp();
+  if (timestamp == 0)
+    timestamp = NOW;
+
+  if (timestamp == NOW)
+  {
+    if (type & QUERY_NODE)
+      prefetch_global_tags< Node_Skeleton >(key_values, rman);
+    if (type & QUERY_WAY)
+      prefetch_global_tags< Way_Skeleton >(key_values, rman);
+    if (type & QUERY_RELATION)
+      prefetch_global_tags< Relation_Skeleton >(key_values, rman);
+  }
+
+  if (type & QUERY_NODE)
+  {
+    Ranges< Uint32_Index > node_ranges = Ranges< Uint32_Index >::global();
+    intersect_constraint_ranges(QUERY_NODE, node_ranges, rman);
+    prefetch_skeletons< Uint32_Index, Node_Skeleton >(node_ranges, timestamp, rman);
+  }
+  if (type & QUERY_WAY)
+  {
+    Ranges< Uint31_Index > way_ranges = Ranges< Uint31_Index >::global();
+    intersect_constraint_ranges(QUERY_WAY, way_ranges, rman);
+    prefetch_skeletons< Uint31_Index, Way_Skeleton >(way_ranges, timestamp, rman);
+  }
+  if (type & QUERY_RELATION)
+  {
+    Ranges< Uint31_Index > rel_ranges = Ranges< Uint31_Index >::global();
+    intersect_constraint_ranges(QUERY_RELATION, rel_ranges, rman);
+    prefetch_skeletons< Uint31_Index, Relation_Skeleton >(rel_ranges, timestamp, rman);
+  }
+}
+
+
 void Query_Statement::execute(Resource_Manager& rman)
 {
   Cpu_Timer cpu(rman, 1);
@@ -949,11 +1101,27 @@ void Query_Statement::execute(Resource_Manager& rman)
     std::vector< Uint31_Index > way_range_vec_31;
     std::vector< Uint31_Index > relation_range_vec_31;
 
+    Ranges< Uint32_Index > node_ranges = Ranges< Uint32_Index >::global();
+    Ranges< Uint31_Index > way_ranges = Ranges< Uint31_Index >::global();
+    Ranges< Uint31_Index > rel_ranges = Ranges< Uint31_Index >::global();
+
+    // With the spatial ranges known in advance, the global tag lookup can skip the slices outside them
+    bool ranges_known = (timestamp == NOW && !key_values.empty());
+    if (ranges_known)
+    {
+      if (type & QUERY_NODE)
+        intersect_constraint_ranges(QUERY_NODE, node_ranges, rman);
+      if (type & QUERY_WAY)
+        intersect_constraint_ranges(QUERY_WAY, way_ranges, rman);
+      if (type & QUERY_RELATION)
+        intersect_constraint_ranges(QUERY_RELATION, rel_ranges, rman);
+    }
+
     if (type & QUERY_NODE)
     {
       progress_1< Node_Skeleton, Node::Id_Type, Uint32_Index >(
           keys, key_values, key_regexes, regkey_regexes, key_nvalues, key_nregexes, regkey_nregexes,
-          node_ids, range_vec_32, timestamp, check_keys_late, rman, *this);
+          node_ids, range_vec_32, timestamp, check_keys_late, rman, *this, ranges_known ? &node_ranges : 0);
       if (node_ids.empty())
         node_answer_state = data_collected;
       collect_nodes(node_ids, node_answer_state, into, rman);
@@ -962,7 +1130,7 @@ void Query_Statement::execute(Resource_Manager& rman)
     {
       progress_1< Way_Skeleton, Way::Id_Type, Uint31_Index >(
 	  keys, key_values, key_regexes, regkey_regexes, key_nvalues, key_nregexes, regkey_nregexes,
-          way_ids, way_range_vec_31, timestamp, check_keys_late, rman, *this);
+          way_ids, way_range_vec_31, timestamp, check_keys_late, rman, *this, ranges_known ? &way_ranges : 0);
       if (way_ids.empty())
         way_answer_state = data_collected;
       collect_elems(QUERY_WAY, way_ids, way_answer_state, into, rman);
@@ -973,7 +1141,8 @@ void Query_Statement::execute(Resource_Manager& rman)
     {
       progress_1< Relation_Skeleton, Relation::Id_Type, Uint31_Index >(
 	  keys, key_values, key_regexes, regkey_regexes, key_nvalues, key_nregexes, regkey_nregexes,
-          relation_ids, relation_range_vec_31, timestamp, check_keys_late, rman, *this);
+          relation_ids, relation_range_vec_31, timestamp, check_keys_late, rman, *this,
+          ranges_known ? &rel_ranges : 0);
       if (relation_ids.empty())
         relation_answer_state = data_collected;
       collect_elems(QUERY_RELATION, relation_ids, relation_answer_state, into, rman);
@@ -1062,33 +1231,26 @@ void Query_Statement::execute(Resource_Manager& rman)
       }
     }
 
-    Ranges< Uint32_Index > node_ranges = Ranges< Uint32_Index >::global();
-    Ranges< Uint31_Index > way_ranges = Ranges< Uint31_Index >::global();
-    Ranges< Uint31_Index > rel_ranges = Ranges< Uint31_Index >::global();
-
     if ((type & QUERY_NODE) && node_answer_state < data_collected)
     {
-      for (std::vector< Query_Constraint* >::iterator it = constraints.begin();
-          it != constraints.end(); ++it)
-        node_ranges.intersect((*it)->get_node_ranges(rman)).swap(node_ranges);
+      if (!ranges_known)
+        intersect_constraint_ranges(QUERY_NODE, node_ranges, rman);
 
       if (!range_vec_32.empty())
         intersect_ranges(node_ranges, range_vec_32).swap(node_ranges);
     }
     if ((type & QUERY_WAY) && way_answer_state < data_collected)
     {
-      for (std::vector< Query_Constraint* >::iterator it = constraints.begin();
-          it != constraints.end(); ++it)
-        way_ranges.intersect((*it)->get_way_ranges(rman)).swap(way_ranges);
+      if (!ranges_known)
+        intersect_constraint_ranges(QUERY_WAY, way_ranges, rman);
 
       if (!way_range_vec_31.empty())
         intersect_ranges(way_ranges, way_range_vec_31).swap(way_ranges);
     }
     if ((type & QUERY_RELATION) && relation_answer_state < data_collected)
     {
-      for (std::vector< Query_Constraint* >::iterator it = constraints.begin();
-          it != constraints.end(); ++it)
-        rel_ranges.intersect((*it)->get_relation_ranges(rman)).swap(rel_ranges);
+      if (!ranges_known)
+        intersect_constraint_ranges(QUERY_RELATION, rel_ranges, rman);
 
       if (!relation_range_vec_31.empty())
         intersect_ranges(rel_ranges, relation_range_vec_31).swap(rel_ranges);
@@ -1097,6 +1259,11 @@ void Query_Statement::execute(Resource_Manager& rman)
     set_progress(3);
     rman.health_check(*this);
 
+    if ((type & QUERY_WAY) && (type & QUERY_NODE) && way_answer_state < data_collected)
+      prefetch_skeletons< Uint31_Index, Way_Skeleton >(way_ranges, timestamp, rman);
+    if ((type & QUERY_RELATION) && (type & (QUERY_NODE | QUERY_WAY)) && relation_answer_state < data_collected)
+      prefetch_skeletons< Uint31_Index, Relation_Skeleton >(rel_ranges, timestamp, rman);
+
     if (type & QUERY_NODE)
     {
       for (std::vector< Query_Constraint* >::iterator it = constraints.begin();
@@ -78,6 +78,8 @@ class Query_Statement : public Output_Statement
     virtual void add_statement(Statement* statement, std::string text);
     virtual std::string get_name() const { return "query"; }
     virtual void execute(Resource_Manager& rman);
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const;
+    virtual void prefetch(Resource_Manager& rman);
 
     static Generic_Statement_Maker< Query_Statement > statement_maker;
 
@@ -160,6 +162,8 @@ class Query_Statement : public Output_Statement
     std::vector< std::pair< std::string, Regular_Expression* > > key_nregexes;
     std::vector< std::pair< Regular_Expression*, Regular_Expression* > > regkey_nregexes;
     std::vector< Query_Constraint* > constraints;
+    // The statement each constraint stems from, null for the global bbox
+    std::vector< const Statement* > constraint_sources;
     std::vector< Statement* > substatements;
     Bbox_Query_Statement* global_bbox_statement;
 
@@ -194,6 +198,8 @@ class Query_Statement : public Output_Statement
         int type, const Id_Constraint< Id_Type >& ids, Answer_State& answer_state, Set& into, Resource_Manager& rman);
 
     void collect_elems(Answer_State& answer_state, Set& into, Resource_Manager& rman);
+    template< typename Index >
+    void intersect_constraint_ranges(int type, Ranges< Index >& ranges, Resource_Manager& rman);
     void apply_all_filters(
         Resource_Manager& rman, uint64 timestamp, Query_Filter_Strategy check_keys_late, Set& into);
 };
@@ -207,6 +213,8 @@ class Has_Kv_Statement : public Statement
     virtual std::string get_name() const { return "has-kv"; }
     virtual std::string get_result_name() const { return ""; }
     virtual void execute(Resource_Manager& rman) {}
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    { return true; }
     virtual ~Has_Kv_Statement();
 
     static Generic_Statement_Maker< Has_Kv_Statement > statement_maker;
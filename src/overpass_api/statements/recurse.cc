@@ -248,6 +248,30 @@ Statement* Recurse_Statement::Criterion_Maker_2::create_criterion(const Token_No
 //-----------------------------------------------------------------------------
 
 
+const File_Properties& parent_relations_file_properties(uint32 member_type)
+{
+  if (member_type == Relation_Entry::NODE)
+    return *osm_base_settings().NODE_RELATIONS;
+  else if (member_type == Relation_Entry::WAY)
+    return *osm_base_settings().WAY_RELATIONS;
+  return *osm_base_settings().RELATION_RELATIONS;
+}
+
+
+/* Collects the relations from the indices req if the reverse membership file has delivered them.
+ * Otherwise all relations must be scanned. */
+template< class Predicate >
+void collect_parent_relations(const Statement& stmt, Resource_Manager& rman,
+    const std::set< Uint31_Index >* req, const Predicate& predicate,
+    std::map< Uint31_Index, std::vector< Relation_Skeleton > >& result)
+{
+  if (req)
+    collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, *req, predicate, result);
+  else
+    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS, predicate, result);
+}
+
+
 template< class TSourceIndex, class TSourceObject >
 Timeless< Uint31_Index, Relation_Skeleton > collect_relations
     (const Statement& stmt, Resource_Manager& rman,
@@ -259,7 +283,10 @@ Timeless< Uint31_Index, Relation_Skeleton > collect_relations
   Timeless< Uint31_Index, Relation_Skeleton > result;
   
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_ids(sources);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  std::set< Uint31_Index > req;
+  if (rman.get_desired_timestamp() != NOW || !collect_parent_indices(
+      stmt, rman, parent_relations_file_properties(source_type), current_ids, req))
+    req = extract_parent_indices(sources);
   rman.health_check(stmt);
 
   if (rman.get_desired_timestamp() == NOW)
@@ -329,7 +356,10 @@ Timeless< Uint31_Index, Relation_Skeleton > collect_relations
   
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_ids(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  std::set< Uint31_Index > req;
+  if (rman.get_desired_timestamp() != NOW || !collect_parent_indices(
+      stmt, rman, parent_relations_file_properties(source_type), current_ids, req))
+    req = extract_parent_indices(sources);
   rman.health_check(stmt);
 
   if (rman.get_desired_timestamp() == NOW)
@@ -401,17 +431,21 @@ Timeless< Uint31_Index, Relation_Skeleton > collect_relations
 
   if (rman.get_desired_timestamp() == NOW)
   {
+    std::set< Uint31_Index > req;
+    const std::set< Uint31_Index >* req_ptr = collect_parent_indices(
+        stmt, rman, *osm_base_settings().RELATION_RELATIONS, current_ids, req) ? &req : 0;
+
     if (!invert_ids)
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           And_Predicate< Relation_Skeleton,
               Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Predicate >
               (Id_Predicate< Relation_Skeleton >(ids),
               Get_Parent_Rels_Predicate(current_ids, Relation_Entry::RELATION)), result.current);
     else if (ids.empty())
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           Get_Parent_Rels_Predicate(current_ids, Relation_Entry::RELATION), result.current);
     else
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           And_Predicate< Relation_Skeleton,
               Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
               Get_Parent_Rels_Predicate >
@@ -466,17 +500,21 @@ Timeless< Uint31_Index, Relation_Skeleton > collect_relations
 
   if (rman.get_desired_timestamp() == NOW)
   {
+    std::set< Uint31_Index > req;
+    const std::set< Uint31_Index >* req_ptr = collect_parent_indices(
+        stmt, rman, *osm_base_settings().RELATION_RELATIONS, current_ids, req) ? &req : 0;
+
     if (!invert_ids)
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           And_Predicate< Relation_Skeleton,
               Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Role_Predicate >
               (Id_Predicate< Relation_Skeleton >(ids),
               Get_Parent_Rels_Role_Predicate(current_ids, Relation_Entry::RELATION, role_id)), result.current);
     else if (ids.empty())
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           Get_Parent_Rels_Role_Predicate(current_ids, Relation_Entry::RELATION, role_id), result.current);
     else
-      collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+      collect_parent_relations(stmt, rman, req_ptr,
           And_Predicate< Relation_Skeleton,
               Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
               Get_Parent_Rels_Role_Predicate >
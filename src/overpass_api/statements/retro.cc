@@ -78,7 +78,10 @@ void Retro_Statement::execute(Resource_Manager& rman)
   rman.set_desired_timestamp(retro_timestamp);
 
   for (std::vector< Statement* >::iterator it = substatements.begin(); it != substatements.end(); ++it)
+  {
+    Statement_Profile_Scope profile_scope(rman, **it);
     (*it)->execute(rman);
+  }
 
   rman.pop_stack_frame();
   rman.health_check(*this);
@@ -212,6 +212,15 @@ class Statement
     // object.
     virtual Query_Constraint* get_query_constraint() { return 0; }
 
+    // Appends the names of the sets the statement reads and writes.
+    // Returns false if the statement cannot tell, then it must be assumed to touch all sets.
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+    { return false; }
+
+    // Lets the kernel read ahead the blocks that execute() will need.
+    // The caller must ensure that the input sets of the statement are already final.
+    virtual void prefetch(Resource_Manager& rman) {}
+
     virtual ~Statement() {}
 
     int get_progress() const { return progress; }
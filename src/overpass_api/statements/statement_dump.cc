@@ -138,6 +138,8 @@ std::string Statement_Dump::dump_compact_map_ql(Statement::Factory& stmt_factory
         output_config = it->second;
       else if (it->first == "bbox")
 	result += "[bbox:" + it->second + "]";
+      else if (it->first == "profile")
+	result += "[profile:" + it->second + "]";
     }
     if (output_val != "")
       result += "[out:" + output_val + output_config + "]";
@@ -209,6 +211,8 @@ std::string Statement_Dump::dump_bbox_map_ql(Statement::Factory& stmt_factory)
         output_config = it->second;
       else if (it->first == "bbox")
 	result += "[bbox:" + it->second + "]";
+      else if (it->first == "profile")
+	result += "[profile:" + it->second + "]";
     }
     if (output_val != "")
       result += "[out:" + output_val + output_config + "]";
@@ -279,6 +283,8 @@ std::string Statement_Dump::dump_pretty_map_ql(Statement::Factory& stmt_factory)
         output_config = it->second;
       else if (it->first == "bbox")
 	result += "[bbox:" + it->second + "]\n";
+      else if (it->first == "profile")
+	result += "[profile:" + it->second + "]\n";
     }
     if (output_val != "")
       result += "[out:" + output_val + output_config + "]\n";
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "../data/abstract_processing.h"
+#include "../data/spilled_set.h"
 #include "../data/utils.h"
 #include "union.h"
 
@@ -63,16 +64,80 @@ void Union_Statement::add_statement(Statement* statement, std::string text)
 }
 
 
+bool Union_Statement::get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const
+{
+  for (std::vector< Statement* >::const_iterator it = substatements.begin(); it != substatements.end(); ++it)
+  {
+    if (!(*it)->get_set_names(inputs, outputs))
+      return false;
+  }
+  outputs.push_back(get_result_name());
+  return true;
+}
+
+
+// Restores the cache of the enclosing scope also if a substatement throws
+struct Shared_Ranges_Cache_Scope
+{
+  Shared_Ranges_Cache_Scope(Resource_Manager& rman_)
+      : rman(rman_), outer_cache(rman_.shared_ranges_cache()) {}
+  ~Shared_Ranges_Cache_Scope() { rman.set_shared_ranges_cache(outer_cache); }
+
+  Resource_Manager& rman;
+  Shared_Ranges_Cache* outer_cache;
+};
+
+
 void Union_Statement::execute(Resource_Manager& rman)
 {
   rman.push_stack_frame();
   rman.move_outward(get_result_name(), get_result_name());
 
+  // The substatements share the ranges of identical filters. An enclosing union may already offer a cache.
+  // A substatement that does not tell which sets it reads and writes is kept out of the cache.
+  Shared_Ranges_Cache_Scope cache_scope(rman);
+  Shared_Ranges_Cache local_cache;
+  Shared_Ranges_Cache* cache = cache_scope.outer_cache ? cache_scope.outer_cache : &local_cache;
+
+  // The substatements never see the accumulated result, hence it can wait on disk if memory gets tight
+  Spilled_Set spilled(rman.get_transaction()->get_db_dir());
+
   for (std::vector< Statement* >::iterator it(substatements.begin());
        it != substatements.end(); ++it)
   {
-    (*it)->execute(rman);
+    std::vector< std::string > inputs;
+    std::vector< std::string > outputs;
+    bool set_names_known = (*it)->get_set_names(inputs, outputs);
+    rman.set_shared_ranges_cache(set_names_known ? cache : 0);
+    {
+      Statement_Profile_Scope profile_scope(rman, **it);
+      (*it)->execute(rman);
+    }
     rman.union_inward((*it)->get_result_name(), get_result_name());
+
+    if (set_names_known)
+    {
+      outputs.push_back(get_result_name());
+      cache->invalidate(outputs);
+    }
+    else
+      cache->clear();
+
+    if (it + 1 != substatements.end())
+    {
+      Set result;
+      rman.swap_inward(get_result_name(), result);
+      spilled.spill_on_pressure(rman, *this, result);
+      rman.swap_inward(get_result_name(), result);
+    }
+  }
+
+  if (!spilled.empty())
+  {
+    Set result;
+    rman.swap_inward(get_result_name(), result);
+    spilled.merge_into(result);
+    rman.swap_inward(get_result_name(), result);
   }
 
   rman.move_all_inward_except(get_result_name());
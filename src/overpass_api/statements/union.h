@@ -34,6 +34,7 @@ class Union_Statement : public Output_Statement
     virtual void add_statement(Statement* statement, std::string text);
     virtual std::string get_name() const { return "union"; }
     virtual void execute(Resource_Manager& rman);
+    virtual bool get_set_names(std::vector< std::string >& inputs, std::vector< std::string >& outputs) const;
     virtual ~Union_Statement() {}
 
     static Generic_Statement_Maker< Union_Statement > statement_maker;
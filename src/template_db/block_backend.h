@@ -94,6 +94,11 @@ struct Block_Backend_Basic_Iterator
   {
     return idx_cache.object();
   }
+  // The raw index in the block buffer, valid until the iterator is incremented
+  const void* index_data() const
+  {
+    return idx_cache.get_ptr_to_raw();
+  }
   const Object& object()
   {
     return obj_cache.object();
@@ -115,7 +120,7 @@ struct Block_Backend_Basic_Iterator
 
 private:
   uint32 block_size;
-  Void64_Pointer< uint64 > buffer;
+  Block_Buffer buffer;
   uint32 buffer_size;
   uint32 idx_block_offset; // Points to the entry that contains the jump offset
   uint32 obj_offset;
@@ -186,7 +191,7 @@ const Block_Backend_Basic_Iterator< Index, Object, Idx_Assessor, File_Handle >&
 {
   if (buffer_size != rhs.buffer_size)
   {
-    Void64_Pointer< uint64 > new_buffer(rhs.buffer_size);
+    Block_Buffer new_buffer(rhs.buffer_size);
     buffer.swap(new_buffer);
   }
 
@@ -252,7 +257,7 @@ void Block_Backend_Basic_Iterator< Index, Object, Idx_Assessor, File_Handle >::i
     uint32 new_buffer_size = (next_idx_block_offset()/block_size + 1) * block_size;
     if (buffer_size < new_buffer_size)
     {
-      Void64_Pointer< uint64 > new_buffer(new_buffer_size);
+      Block_Buffer new_buffer(new_buffer_size);
       memcpy(new_buffer.ptr, buffer.ptr, block_size);
       buffer.swap(new_buffer);
       buffer_size = new_buffer_size;
@@ -266,6 +271,21 @@ void Block_Backend_Basic_Iterator< Index, Object, Idx_Assessor, File_Handle >::i
 //-----------------------------------------------------------------------------
 
 
+// Continuation blocks of oversized objects are read with check_idx = false and never skipped.
+// Their leading block always has summary zero and no valid id Bloom filter,
+// hence it is never skipped either.
+template< typename File_Blocks, typename File_Iterator >
+void skip_filtered_blocks(
+    const File_Blocks& file_blocks, File_Iterator& file_it, const File_Iterator& file_end,
+    const Block_Filter* filter)
+{
+  if (!filter)
+    return;
+  while (!(file_it == file_end) && !file_blocks.may_contain(file_it, *filter))
+    ++file_it;
+}
+
+
 struct Flat_Idx_Assessor
 {
   bool is_relevant(uint8*)
@@ -278,12 +298,14 @@ struct Flat_Idx_Assessor
 template< typename File_Blocks, typename File_Iterator >
 struct Flat_File_Handle
 {
-  Flat_File_Handle(File_Blocks& file_blocks_, bool is_end)
+  Flat_File_Handle(File_Blocks& file_blocks_, bool is_end, const Block_Filter* filter_ = 0)
       : file_blocks(&file_blocks_), file_it(is_end ? file_blocks_.flat_end() : file_blocks_.flat_begin()),
-      file_end(file_blocks_.flat_end()) {}
+      file_end(file_blocks_.flat_end()), filter(filter_) {}
 
   bool next(uint64* ptr, bool check_idx = true)
   {
+    if (check_idx)
+      skip_filtered_blocks(*file_blocks, file_it, file_end, filter);
     if (file_it == file_end)
       return false;
     file_blocks->read_block(file_it, ptr, check_idx);
@@ -300,6 +322,7 @@ private:
   const File_Blocks* file_blocks;
   File_Iterator file_it;
   File_Iterator file_end;
+  const Block_Filter* filter;
 };
 
 
@@ -311,9 +334,10 @@ struct Block_Backend_Flat_Iterator
   typedef File_Blocks< Index, Iterator > File_Blocks_;
   typedef Flat_File_Handle< File_Blocks_, typename File_Blocks_::Flat_Iterator > File_Handle_;
 
-  Block_Backend_Flat_Iterator(File_Blocks_& file_blocks, uint32 block_size, bool is_end = false)
+  Block_Backend_Flat_Iterator(
+      File_Blocks_& file_blocks, uint32 block_size, bool is_end = false, const Block_Filter* filter = 0)
       : Block_Backend_Basic_Iterator< Index, Object, Flat_Idx_Assessor, File_Handle_ >(
-          block_size, File_Handle_(file_blocks, is_end), Flat_Idx_Assessor()) {}
+          block_size, File_Handle_(file_blocks, is_end, filter), Flat_Idx_Assessor()) {}
 
   Block_Backend_Flat_Iterator(const Block_Backend_Flat_Iterator& rhs)
       : Block_Backend_Basic_Iterator< Index, Object, Flat_Idx_Assessor, File_Handle_ >(rhs) {}
@@ -346,11 +370,14 @@ private:
 template< typename File_Blocks, typename File_Iterator >
 struct Discrete_File_Handle
 {
-  Discrete_File_Handle(File_Blocks& file_blocks_, const File_Iterator& file_it_)
-      : file_blocks(&file_blocks_), file_it(file_it_), file_end(file_blocks_.discrete_end()) {}
+  Discrete_File_Handle(
+      File_Blocks& file_blocks_, const File_Iterator& file_it_, const Block_Filter* filter_ = 0)
+      : file_blocks(&file_blocks_), file_it(file_it_), file_end(file_blocks_.discrete_end()), filter(filter_) {}
 
   bool next(uint64* ptr, bool check_idx = true)
   {
+    if (check_idx)
+      skip_filtered_blocks(*file_blocks, file_it, file_end, filter);
     if (file_it == file_end)
       return false;
     file_blocks->read_block(file_it, ptr, check_idx);
@@ -367,6 +394,7 @@ private:
   const File_Blocks* file_blocks;
   File_Iterator file_it;
   File_Iterator file_end;
+  const Block_Filter* filter;
 };
 
 
@@ -380,9 +408,10 @@ struct Block_Backend_Discrete_Iterator
   typedef Discrete_File_Handle< File_Blocks_, typename File_Blocks_::Discrete_Iterator > File_Handle_;
 
   Block_Backend_Discrete_Iterator
-      (File_Blocks_& file_blocks, const Iterator& index_it, const Iterator& index_end, uint32 block_size)
+      (File_Blocks_& file_blocks, const Iterator& index_it, const Iterator& index_end, uint32 block_size,
+       const Block_Filter* filter = 0)
       : Block_Backend_Basic_Iterator< Index, Object, Discrete_Idx_Assessor< Index, Iterator >, File_Handle_ >(
-          block_size, File_Handle_(file_blocks, file_blocks.discrete_begin(index_it, index_end)),
+          block_size, File_Handle_(file_blocks, file_blocks.discrete_begin(index_it, index_end), filter),
           Discrete_Idx_Assessor< Index, Iterator >(index_it, index_end)) {}
 
   Block_Backend_Discrete_Iterator(File_Blocks_& file_blocks, uint32 block_size)
@@ -422,12 +451,15 @@ template< typename File_Blocks, typename Index >
 struct Range_File_Handle
 {
   Range_File_Handle(File_Blocks& file_blocks_,
-      const File_Blocks_Range_Iterator< Index, typename Ranges< Index >::Iterator >& file_it_)
+      const File_Blocks_Range_Iterator< Index, typename Ranges< Index >::Iterator >& file_it_,
+      const Block_Filter* filter_ = 0)
       : file_blocks(&file_blocks_), file_it(file_it_),
-      file_end(file_blocks_.template range_end< typename Ranges< Index >::Iterator >()) {}
+      file_end(file_blocks_.template range_end< typename Ranges< Index >::Iterator >()), filter(filter_) {}
 
   bool next(uint64* ptr, bool check_idx = true)
   {
+    if (check_idx)
+      skip_filtered_blocks(*file_blocks, file_it, file_end, filter);
     if (file_it == file_end)
       return false;
     file_blocks->read_block(file_it, ptr, check_idx);
@@ -444,6 +476,7 @@ private:
   const File_Blocks* file_blocks;
   File_Blocks_Range_Iterator< Index, typename Ranges< Index >::Iterator > file_it;
   File_Blocks_Range_Iterator< Index, typename Ranges< Index >::Iterator > file_end;
+  const Block_Filter* filter;
 };
 
 
@@ -458,10 +491,10 @@ struct Block_Backend_Range_Iterator
   Block_Backend_Range_Iterator(
       File_Blocks_& file_blocks,
       const typename Ranges< Index >::Iterator& index_it, const typename Ranges< Index >::Iterator& index_end,
-      uint32 block_size)
+      uint32 block_size, const Block_Filter* filter = 0)
       : Block_Backend_Basic_Iterator< Index, Object,
           Range_Idx_Assessor< Index, typename Ranges< Index >::Iterator >, File_Handle_ >(
-          block_size, File_Handle_(file_blocks, file_blocks.range_begin(index_it, index_end)),
+          block_size, File_Handle_(file_blocks, file_blocks.range_begin(index_it, index_end), filter),
           Range_Idx_Assessor< Index, typename Ranges< Index >::Iterator >(index_it, index_end)) {}
 
   Block_Backend_Range_Iterator(File_Blocks_& file_blocks, uint32 block_size)
@@ -518,8 +551,24 @@ struct Block_Backend
   Range_Iterator range_begin(const Ranges< TIndex >& arg)
   { return Range_Iterator(file_blocks, arg.begin(), arg.end(), block_size); }
 
+  // The iterators skip the blocks whose summary or id Bloom filter the filter rejects.
+  // The filter must outlive the iterators.
+  Flat_Iterator flat_begin(const Block_Filter& filter)
+  { return Flat_Iterator(file_blocks, block_size, false, usable_filter(filter)); }
+  Discrete_Iterator discrete_begin(TIterator begin, TIterator end, const Block_Filter& filter)
+  { return Discrete_Iterator(file_blocks, begin, end, block_size, usable_filter(filter)); }
+  Range_Iterator range_begin(const Ranges< TIndex >& arg, const Block_Filter& filter)
+  { return Range_Iterator(file_blocks, arg.begin(), arg.end(), block_size, usable_filter(filter)); }
+
   const Range_Iterator& range_end() const { return *range_end_it; }
 
+  void prefetch(const Ranges< TIndex >& arg, uint64 max_bytes)
+  { file_blocks.prefetch(arg.begin(), arg.end(), max_bytes); }
+
+  // An estimate of the amount of data in the ranges that does not read any block
+  uint64 range_size(const Ranges< TIndex >& arg, uint64 limit)
+  { return file_blocks.range_size(arg.begin(), arg.end(), limit); }
+
   template< typename Container >
   void update(
       const std::map< TIndex, std::set< TObject > >& to_delete,
@@ -536,6 +585,13 @@ private:
   Range_Iterator* range_end_it;
   uint32 block_size;
   std::string data_filename;
+
+  const Block_Filter* usable_filter(const Block_Filter& filter) const
+  {
+    return ((Block_Summary< TObject >::enabled || Block_Index_Summary< TIndex >::enabled)
+            && file_blocks.has_block_summaries())
+        || (Block_Id_Bloom< TObject >::enabled && file_blocks.id_bloom_size()) ? &filter : 0;
+  }
 };
 
 
@@ -545,6 +601,8 @@ Block_Backend< TIndex, TObject, TIterator >::Block_Backend(File_Blocks_Index_Bas
     block_size(index_->get_block_size() * index_->get_compression_factor()),
     data_filename(index_->get_data_file_name())
 {
+  if (Block_Id_Bloom< TObject >::enabled)
+    file_blocks.enable_id_blooms();
   flat_end_it = new Flat_Iterator(file_blocks, block_size, true);
   discrete_end_it = new Discrete_Iterator(file_blocks, block_size);
   range_end_it = new Range_Iterator(file_blocks, block_size);
@@ -804,6 +804,52 @@ int main(int argc, char* args[])
   if ((test_to_execute == "") || (test_to_execute == "20"))
     read_test(20);
 
+  if ((test_to_execute == "") || (test_to_execute == "21"))
+    std::cout<<"** Append objects in ascending order to an empty file\n";
+  remove((BASE_DIRECTORY + Test_File().get_file_name_trunk()
+      + Test_File().get_data_suffix()
+      + Test_File().get_index_suffix()).c_str());
+  remove((BASE_DIRECTORY + Test_File().get_file_name_trunk()
+      + Test_File().get_data_suffix()).c_str());
+  try
+  {
+    Nonsynced_Transaction transaction(true, false, BASE_DIRECTORY, "");
+    Test_File tf;
+    Block_Backend_Appender< IntIndex, IntObject > appender(transaction.data_index(&tf));
+    for (int i = 0; i < 40; ++i)
+    {
+      objects.clear();
+      for (int j = 0; j <= i%7; ++j)
+        objects.insert(IntObject(i*10 + j));
+      appender.append(IntIndex(i), objects);
+    }
+    objects.clear();
+    for (int j = 0; j < 150; ++j)
+      objects.insert(IntObject(40000 + j));
+    appender.append(IntIndex(40), objects);
+    objects.clear();
+    for (int j = 150; j < 300; ++j)
+      objects.insert(IntObject(40000 + j));
+    appender.append(IntIndex(40), objects);
+    appender.append(IntIndex(41), IntObject(1000001000));
+    appender.append(IntIndex(41), IntObject(4110));
+    appender.append(IntIndex(42), IntObject(420));
+    appender.append(IntIndex(45), IntObject(1000000200));
+    appender.append(IntIndex(45), IntObject(1000000201));
+    appender.append(IntIndex(45), IntObject(1000000202));
+    for (int i = 90; i < 100; ++i)
+      appender.append(IntIndex(i), IntObject(i*10));
+    appender.finish();
+  }
+  catch (File_Error& e)
+  {
+    std::cout<<"File error catched in part 40: "
+    <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+    std::cout<<"(This is unexpected)\n";
+  }
+  if ((test_to_execute == "") || (test_to_execute == "21"))
+    read_test(21);
+
   remove((BASE_DIRECTORY + Test_File().get_file_name_trunk()
       + Test_File().get_data_suffix()
       + Test_File().get_index_suffix()).c_str());
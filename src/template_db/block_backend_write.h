@@ -24,13 +24,138 @@
 #include <type_traits>
 
 
-template< typename Index, typename Object, typename File_Blocks, typename Iterator >
+// Merges the Block_Summary of all objects in the block. Oversized blocks are not summarized.
+// Without an object summary, the Block_Index_Summary of all indices of the block is merged instead.
+template< typename Index, typename Object >
+uint32 summarize_block(const uint64* block)
+{
+  if (!Block_Summary< Object >::enabled && !Block_Index_Summary< Index >::enabled)
+    return 0;
+
+  const uint8* begin = (const uint8*)block;
+  const uint8* end = begin + *(const uint32*)block;
+  const uint8* idx_ptr = begin + 4;
+  uint32 summary = 0;
+  bool first = true;
+  while (idx_ptr < end)
+  {
+    const uint8* next_idx_ptr = begin + *(const uint32*)idx_ptr;
+    if (next_idx_ptr > end)
+      return 0;
+    if (!Block_Summary< Object >::enabled)
+    {
+      uint32 idx_summary = Block_Index_Summary< Index >::of(idx_ptr + 4);
+      summary = first ? idx_summary : Block_Index_Summary< Index >::merge(summary, idx_summary);
+      first = false;
+      idx_ptr = next_idx_ptr;
+      continue;
+    }
+    const uint8* obj_ptr = idx_ptr + 4 + Index::size_of((void*)(idx_ptr + 4));
+    while (obj_ptr < next_idx_ptr)
+    {
+      uint32 obj_summary = Block_Summary< Object >::of(obj_ptr);
+      summary = first ? obj_summary : Block_Summary< Object >::merge(summary, obj_summary);
+      first = false;
+      obj_ptr += Object::size_of((void*)obj_ptr);
+    }
+    idx_ptr = next_idx_ptr;
+  }
+  return summary;
+}
+
+
+// Adds the ids of all objects in the block to the Bloom filter slot.
+// Returns false if the object type has no ids or the block is malformed.
+template< typename Index, typename Object >
+bool fill_id_bloom(const uint64* block, uint8* slot, uint32 slot_size)
+{
+  if (!Block_Id_Bloom< Object >::enabled)
+    return false;
+
+  Id_Bloom_Slot::clear(slot, slot_size);
+  const uint8* begin = (const uint8*)block;
+  const uint8* end = begin + *(const uint32*)block;
+  const uint8* idx_ptr = begin + 4;
+  while (idx_ptr < end)
+  {
+    const uint8* next_idx_ptr = begin + *(const uint32*)idx_ptr;
+    if (next_idx_ptr > end)
+      return false;
+    const uint8* obj_ptr = idx_ptr + 4 + Index::size_of((void*)(idx_ptr + 4));
+    while (obj_ptr < next_idx_ptr)
+    {
+      Id_Bloom_Slot::add(slot, slot_size, Block_Id_Bloom< Object >::id_of(obj_ptr));
+      obj_ptr += Object::size_of((void*)obj_ptr);
+    }
+    idx_ptr = next_idx_ptr;
+  }
+  return true;
+}
+
+
+template< typename Index, typename File_Blocks >
+struct File_Handler
+{
+  File_Handler(
+      File_Blocks& file_blocks_, const std::vector< Index >& relevant_idxs,
+      uint32 block_size_, const std::string& data_filename_,
+      uint32 (*summarize_)(const uint64*) = 0,
+      bool (*fill_bloom_)(const uint64*, uint8*, uint32) = 0)
+      : file_blocks(file_blocks_),
+        file_it(file_blocks.write_begin(relevant_idxs.begin(), relevant_idxs.end(), true)),
+        block_size(block_size_), data_filename(data_filename_), summarize(summarize_),
+        fill_bloom(fill_bloom_) {}
+
+  File_Handler(
+      File_Blocks& file_blocks_, const typename File_Blocks::Write_Iterator& file_it_,
+      uint32 block_size_, const std::string& data_filename_,
+      uint32 (*summarize_)(const uint64*) = 0,
+      bool (*fill_bloom_)(const uint64*, uint8*, uint32) = 0)
+      : file_blocks(file_blocks_), file_it(file_it_),
+        block_size(block_size_), data_filename(data_filename_), summarize(summarize_),
+        fill_bloom(fill_bloom_) {}
+        
+  void insert_block(uint64* ptr)
+  { file_it = file_blocks.insert_block(file_it, ptr, summary_of(ptr), bloom_of(ptr)); }
+  void replace_block(uint64* ptr)
+  {
+    file_it = file_blocks.replace_block(file_it, ptr, summary_of(ptr), bloom_of(ptr));
+    ++file_it;
+  }
+  void erase_block()
+  { file_it = file_blocks.erase_block(file_it); }
+  
+  File_Blocks& file_blocks;
+  typename File_Blocks::Write_Iterator file_it;
+  uint32 block_size;
+  std::string data_filename;
+
+private:
+  uint32 (*summarize)(const uint64*);
+  bool (*fill_bloom)(const uint64*, uint8*, uint32);
+  std::vector< uint8 > bloom;
+
+  uint32 summary_of(const uint64* ptr) const
+  { return summarize && *(const uint32*)ptr <= block_size ? summarize(ptr) : 0; }
+
+  const uint8* bloom_of(const uint64* ptr)
+  {
+    uint32 slot_size = file_blocks.id_bloom_size();
+    if (!fill_bloom || !slot_size || *(const uint32*)ptr > block_size)
+      return 0;
+    bloom.resize(slot_size);
+    return fill_bloom(ptr, &bloom[0], slot_size) ? &bloom[0] : 0;
+  }
+};
+
+
+template< typename Index, typename Object, typename File_Handler >
 void flush_if_necessary_and_write_obj(
-    uint64* start_ptr, uint8*& insert_ptr, File_Blocks& file_blocks, Iterator& file_it,
-    const Index& idx, const Object& obj, uint32 block_size, const std::string& data_filename)
+    uint64* start_ptr, uint8*& insert_ptr, File_Handler& handler, const Index& idx, const Object& obj)
 {
   uint32 idx_size = idx.size_of();
   uint32 obj_size = obj.size_of();
+  uint32 block_size = handler.block_size;
 
   if (insert_ptr - (uint8*)start_ptr + obj_size > block_size)
   {
@@ -39,12 +164,12 @@ void flush_if_necessary_and_write_obj(
     {
       *(uint32*)start_ptr = bytes_written;
       *(((uint32*)start_ptr)+1) = bytes_written;
-      file_it = file_blocks.insert_block(file_it, start_ptr);
+      handler.insert_block(start_ptr);
     }
     if (idx_size + obj_size + 8 > block_size)
     {
       if (obj_size > 64*1024*1024)
-          throw File_Error(0, data_filename, "Block_Backend: an item's size exceeds limit of 64 MiB.");
+          throw File_Error(0, handler.data_filename, "Block_Backend: an item's size exceeds limit of 64 MiB.");
 
       uint buf_scale = (idx_size + obj_size + 7)/block_size + 1;
       Void64_Pointer< uint64 > large_buf(buf_scale * block_size);
@@ -55,10 +180,11 @@ void flush_if_necessary_and_write_obj(
 
       for (uint i = 0; i+1 < buf_scale; ++i)
       {
-        file_it = file_blocks.insert_block(file_it, large_buf.ptr + i*block_size/8, block_size, idx);
+        handler.file_it = handler.file_blocks.insert_block(
+            handler.file_it, large_buf.ptr + i*block_size/8, block_size, idx);
       }
-      file_it = file_blocks.insert_block(
-          file_it, large_buf.ptr + (buf_scale-1)*block_size/8, idx_size + obj_size + 8 - block_size*(buf_scale-1),
+      handler.file_it = handler.file_blocks.insert_block(
+          handler.file_it, large_buf.ptr + (buf_scale-1)*block_size/8, idx_size + obj_size + 8 - block_size*(buf_scale-1),
           idx);
 
       insert_ptr = ((uint8*)start_ptr) + 8 + idx_size;
@@ -73,33 +199,6 @@ void flush_if_necessary_and_write_obj(
 }
 
 
-template< typename Index, typename File_Blocks >
-struct File_Handler
-{
-  File_Handler(
-      File_Blocks& file_blocks_, const std::vector< Index >& relevant_idxs,
-      uint32 block_size_, const std::string& data_filename_)
-      : file_blocks(file_blocks_),
-        file_it(file_blocks.write_begin(relevant_idxs.begin(), relevant_idxs.end(), true)),
-        block_size(block_size_), data_filename(data_filename_) {}
-        
-  void insert_block(uint64* ptr)
-  { file_it = file_blocks.insert_block(file_it, ptr); }
-  void replace_block(uint64* ptr)
-  {
-    file_it = file_blocks.replace_block(file_it, ptr);
-    ++file_it;
-  }
-  void erase_block()
-  { file_it = file_blocks.erase_block(file_it); }
-  
-  File_Blocks& file_blocks;
-  typename File_Blocks::Write_Iterator file_it;
-  uint32 block_size;
-  std::string data_filename;
-};
-
-
 template< typename Container >
 uint32 total_size_of(const Container& container)
 {
@@ -828,8 +927,7 @@ void update_segments(
   {
     while (cur_insert != insert_it->second.end())
     {
-      flush_if_necessary_and_write_obj(
-          dest.ptr, pos, file_handler.file_blocks, file_handler.file_it, idx, *cur_insert, file_handler.block_size, file_handler.data_filename);
+      flush_if_necessary_and_write_obj(dest.ptr, pos, file_handler, idx, *cur_insert);
       ++cur_insert;
       ++count.after;
     }
@@ -867,7 +965,9 @@ void Block_Backend< Index, Object, Iterator >::update(
   while (iit != to_insert.end())
     relevant_idxs.push_back((iit++)->first);
 
-  File_Handler< Index, File_Blocks_ > handler(file_blocks, relevant_idxs, block_size, data_filename);
+  File_Handler< Index, File_Blocks_ > handler(
+      file_blocks, relevant_idxs, block_size, data_filename,
+      &summarize_block< Index, Object >, &fill_id_bloom< Index, Object >);
       
   std::map< Index, Object_Set_Predicate< Object > > to_delete_;
   for (const auto& i : to_delete)
@@ -885,4 +985,171 @@ void Block_Backend< Index, Object, Iterator >::update(
 }
 
 
+/* Writes objects in ascending order of their indices into an empty file.
+ * The blocks are filled completely and each block is written exactly once.
+ * Objects of the same index may be appended by consecutive calls.
+ * The index of the file is written as usual when the transaction ends. */
+template< typename Index, typename Object >
+class Block_Backend_Appender
+{
+public:
+  typedef File_Blocks< Index, typename std::vector< Index >::const_iterator > File_Blocks_;
+
+  Block_Backend_Appender(File_Blocks_Index_Base* index);
+
+  template< typename Container >
+  void append(const Index& idx, const Container& objects);
+  void append(const Index& idx, const Object& obj);
+  // Writes the last, partially filled block. Must be called after the last append.
+  void finish();
+
+private:
+  File_Blocks_ file_blocks;
+  uint32 block_size;
+  File_Handler< Index, File_Blocks_ > handler;
+  Void64_Pointer< uint64 > buffer;
+  std::vector< uint8 > last_idx;
+  bool segments_mode;
+  uint32 entry_start;
+  uint8* insert_ptr;
+
+  void start_entry(const Index& idx);
+  void flush_group(uint32 until);
+};
+
+
+template< typename Index, typename Object >
+Block_Backend_Appender< Index, Object >::Block_Backend_Appender(File_Blocks_Index_Base* index)
+  : file_blocks(index),
+    block_size(index->get_block_size() * index->get_compression_factor()),
+    handler(file_blocks, file_blocks.write_end(), block_size, index->get_data_file_name(),
+        &summarize_block< Index, Object >, &fill_id_bloom< Index, Object >),
+    buffer(block_size), segments_mode(false), entry_start(0), insert_ptr(((uint8*)buffer.ptr) + 4)
+{
+  if (Block_Id_Bloom< Object >::enabled)
+    file_blocks.enable_id_blooms();
+  if (!index->empty())
+    throw File_Error(0, index->get_data_file_name(), "Block_Backend_Appender: file is not empty");
+}
+
+
+template< typename Index, typename Object >
+template< typename Container >
+void Block_Backend_Appender< Index, Object >::append(const Index& idx, const Container& objects)
+{
+  for (typename Container::const_iterator it = objects.begin(); it != objects.end(); ++it)
+    append(idx, *it);
+}
+
+
+template< typename Index, typename Object >
+void Block_Backend_Appender< Index, Object >::append(const Index& idx, const Object& obj)
+{
+  uint8* start = (uint8*)buffer.ptr;
+  if (last_idx.empty() || !idx.equal(&last_idx[0]))
+    start_entry(idx);
+
+  if (segments_mode)
+  {
+    flush_if_necessary_and_write_obj(buffer.ptr, insert_ptr, handler, idx, obj);
+    return;
+  }
+
+  uint32 obj_size = obj.size_of();
+  if (insert_ptr - start + obj_size > block_size)
+  {
+    // Writing the block clears the buffer behind the payload, hence save the current entry
+    std::vector< uint8 > entry(start + entry_start, insert_ptr);
+    flush_group(entry_start);
+    if (entry.size() + obj_size <= block_size - 4)
+    {
+      // The entry fits into a block of its own, hence continue with a fresh block
+      memcpy(start + 4, &entry[0], entry.size());
+      entry_start = 4;
+      insert_ptr = start + 4 + entry.size();
+    }
+    else
+    {
+      // The entry exceeds a block, hence it continues as a sequence of segments
+      memcpy(start + 8, &entry[4], entry.size() - 4);
+      insert_ptr = start + 4 + entry.size();
+      segments_mode = true;
+      flush_if_necessary_and_write_obj(buffer.ptr, insert_ptr, handler, idx, obj);
+      return;
+    }
+  }
+
+  obj.to_data(insert_ptr);
+  insert_ptr += obj_size;
+  *(uint32*)(start + entry_start) = insert_ptr - start;
+}
+
+
+template< typename Index, typename Object >
+void Block_Backend_Appender< Index, Object >::start_entry(const Index& idx)
+{
+  if (!last_idx.empty() && idx.leq(&last_idx[0]))
+    throw File_Error(0, handler.data_filename, "Block_Backend_Appender: indices are not ascending");
+
+  uint8* start = (uint8*)buffer.ptr;
+  uint32 idx_size = idx.size_of();
+  if (segments_mode)
+  {
+    uint32 size = insert_ptr - start;
+    if (size > 8 + last_idx.size())
+    {
+      *(uint32*)start = size;
+      *(((uint32*)start)+1) = size;
+      handler.insert_block(buffer.ptr);
+    }
+    segments_mode = false;
+    insert_ptr = start + 4;
+  }
+  else if (insert_ptr - start + 4 + idx_size > block_size)
+    flush_group(insert_ptr - start);
+
+  last_idx.resize(idx_size);
+  idx.to_data(&last_idx[0]);
+
+  entry_start = insert_ptr - start;
+  memcpy(insert_ptr + 4, &last_idx[0], idx_size);
+  insert_ptr += 4 + idx_size;
+  *(uint32*)(start + entry_start) = insert_ptr - start;
+}
+
+
+// Writes the entries before the offset until as a block
+template< typename Index, typename Object >
+void Block_Backend_Appender< Index, Object >::flush_group(uint32 until)
+{
+  if (until <= 4)
+    return;
+
+  *(uint32*)buffer.ptr = until;
+  handler.insert_block(buffer.ptr);
+  insert_ptr = ((uint8*)buffer.ptr) + 4;
+}
+
+
+template< typename Index, typename Object >
+void Block_Backend_Appender< Index, Object >::finish()
+{
+  uint8* start = (uint8*)buffer.ptr;
+  if (segments_mode)
+  {
+    uint32 size = insert_ptr - start;
+    if (size > 8 + last_idx.size())
+    {
+      *(uint32*)start = size;
+      *(((uint32*)start)+1) = size;
+      handler.insert_block(buffer.ptr);
+    }
+    segments_mode = false;
+  }
+  else
+    flush_group(insert_ptr - start);
+  insert_ptr = start + 4;
+}
+
+
 #endif
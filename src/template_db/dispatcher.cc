@@ -282,6 +282,16 @@ void Global_Resource_Planner::remove_entry(std::vector< Reader_Entry >::iterator
 }
 
 
+void Global_Resource_Planner::report_space(pid_t pid, uint64 peak_space)
+{
+  for (std::vector< Reader_Entry >::iterator it = active.begin(); it != active.end(); ++it)
+  {
+    if (it->client_pid == pid)
+      it->peak_space = std::max(it->peak_space, peak_space);
+  }
+}
+
+
 void Global_Resource_Planner::remove(pid_t pid)
 {
   bool was_active = false;
@@ -450,7 +460,7 @@ Dispatcher::Dispatcher(
     Dispatcher_Logger* logger_)
     : socket(dispatcher_share_name_, socket_dir.empty() ? db_dir_ : socket_dir,
           max_num_reading_processes_, max_num_socket_clients),
-      transaction_insulator(db_dir_, controlled_files_), writing_process(0),
+      transaction_insulator(db_dir_, shadow_name_, controlled_files_), writing_process(0),
       shadow_name(shadow_name_),
       dispatcher_share_name(dispatcher_share_name_),
       logger(logger_),
@@ -507,7 +517,7 @@ Dispatcher::Dispatcher(
 
   if (file_exists(shadow_name))
   {
-    transaction_insulator.copy_shadows_to_mains();
+    transaction_insulator.move_shadows_to_mains();
     remove(shadow_name.c_str());
   }
   else if (file_exists(shadow_name + ".next"))
@@ -517,13 +527,16 @@ Dispatcher::Dispatcher(
   }
   transaction_insulator.remove_shadows();
   transaction_insulator.remove_migrated();
+  transaction_insulator.remove_snapshots();
   remove((shadow_name + ".lock").c_str());
   transaction_insulator.set_current_footprints();
+  transaction_insulator.publish_snapshot();
 }
 
 
 Dispatcher::~Dispatcher()
 {
+  transaction_insulator.remove_snapshots();
   munmap((void*)dispatcher_shm_ptr, SHM_SIZE + transaction_insulator.db_dir().size() + shadow_name.size());
   shm_unlink(dispatcher_share_name.c_str());
 }
@@ -560,7 +573,7 @@ void Dispatcher::write_start(pid_t pid)
   {
     Raw_File shadow_file(shadow_name + ".lock", O_RDWR|O_CREAT|O_EXCL, S_666, "write_start:1");
 
-    transaction_insulator.copy_mains_to_shadows();
+    transaction_insulator.remove_shadows();
     transaction_insulator.write_index_of_empty_blocks();
     if (logger)
       logger->write_start(pid, transaction_insulator.registered_pids());
@@ -617,11 +630,21 @@ void Dispatcher::migrate_rollback(pid_t pid)
 
 bool Dispatcher::get_lock_for_idx_change(pid_t pid)
 {
-  if (!processes_reading_idx.empty())
+  // Readers of a snapshot keep their version of the files.
+  // Only readers of the main files must have loaded the index before it changes.
+  std::set< pid_t > reading_main_idx;
+  for (std::set< pid_t >::const_iterator it = processes_reading_idx.begin();
+      it != processes_reading_idx.end(); ++it)
+  {
+    if (!transaction_insulator.snapshot_of(*it))
+      reading_main_idx.insert(*it);
+  }
+
+  if (!reading_main_idx.empty())
   {
     pending_commit = true;
     if (logger)
-      logger->write_pending(pid, processes_reading_idx);
+      logger->write_pending(pid, reading_main_idx);
     return false;
   }
   pending_commit = false;
@@ -638,7 +661,7 @@ void Dispatcher::write_commit(pid_t pid)
   try
   {
     Raw_File shadow_file(shadow_name, O_RDWR|O_CREAT|O_EXCL, S_666, "write_commit:1");
-    transaction_insulator.copy_shadows_to_mains();
+    transaction_insulator.move_shadows_to_mains();
   }
   catch (File_Error e)
   {
@@ -650,6 +673,7 @@ void Dispatcher::write_commit(pid_t pid)
   transaction_insulator.remove_shadows();
   remove((shadow_name + ".lock").c_str());
   transaction_insulator.set_current_footprints();
+  transaction_insulator.publish_snapshot();
   writing_process = 0;
 }
 
@@ -675,6 +699,7 @@ void Dispatcher::migrate_commit(pid_t pid)
   transaction_insulator.remove_migrated();
   remove((shadow_name + ".lock").c_str());
   transaction_insulator.set_current_footprints();
+  transaction_insulator.publish_snapshot();
   writing_process = 0;
 }
 
@@ -868,6 +893,8 @@ void Dispatcher::standby_loop(uint64 milliseconds)
         }
 
         connection_per_pid.get(client_pid)->send_result(command);
+        if (command == REQUEST_READ_AND_IDX)
+          connection_per_pid.get(client_pid)->send_data(transaction_insulator.snapshot_of(client_pid));
       }
       else if (command == PURGE)
       {
@@ -908,6 +935,18 @@ void Dispatcher::standby_loop(uint64 milliseconds)
 
 	connection_per_pid.get(client_pid)->send_result(target_pid);
       }
+      else if (command == REPORT_SPACE)
+      {
+	std::vector< uint32 > arguments = connection_per_pid.get(client_pid)->get_arguments(2);
+	if (arguments.size() < 2)
+        {
+          connection_per_pid.get(client_pid)->clear_state();
+	  continue;
+        }
+
+        global_resource_planner.report_space(client_pid, (((uint64)arguments[1])<<32 | arguments[0]));
+	connection_per_pid.get(client_pid)->send_result(command);
+      }
       else if (command == QUERY_MY_STATUS)
       {
         Blocking_Client_Socket* connection = connection_per_pid.get(client_pid);
@@ -1074,7 +1113,7 @@ void Dispatcher::output_status()
       else
         status<<READ_IDX_FINISHED;
       status<<' '<<i.client_pid<<' '<<i.client_token<<' '
-          <<i.max_space<<' '<<i.max_time<<' '<<i.start_time<<'\n';
+          <<i.max_space<<' '<<i.max_time<<' '<<i.start_time<<' '<<i.peak_space<<'\n';
 
       collected_pids.push_back(i.client_pid);
     }
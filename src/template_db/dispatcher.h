@@ -59,11 +59,12 @@ struct Dispatcher_Logger
 struct Reader_Entry
 {
   Reader_Entry(uint32 client_pid_, uint64 max_space_, uint32 max_time_, uint32 client_token_, uint32 start_time_)
-    : client_pid(client_pid_), max_space(max_space_), max_time(max_time_), start_time(start_time_),
+    : client_pid(client_pid_), max_space(max_space_), peak_space(0), max_time(max_time_), start_time(start_time_),
       client_token(client_token_) {}
 
   pid_t client_pid;
   uint64 max_space;
+  uint64 peak_space;
   uint32 max_time;
   uint32 start_time;
   uint32 client_token;
@@ -109,6 +110,9 @@ public:
   // Unregisters the process
   void remove(pid_t pid);
 
+  // Records the peak heap usage the process has reported
+  void report_space(pid_t pid, uint64 peak_space);
+
   // Unregister all processes that don't have a connection anymore
   void purge(Connection_Per_Pid_Map& connection_per_pid);
 
@@ -197,6 +201,7 @@ public:
   static const uint32 PING = 0x1400;
   static const uint32 UNREGISTER_PID = 0x1500;
   static const uint32 QUERY_BY_TOKEN = 0x1601;
+  static const uint32 REPORT_SPACE = 0x1702;
 
   static const uint32 PROTOCOL_INVALID = 0x1f100;
   static const uint32 RATE_LIMITED = 0x1f200;
@@ -238,9 +243,10 @@ public:
       index file. */
   void write_rollback(pid_t pid);
 
-  /** Copies the shadow files onto the main index files. A lock prevents
-      that incomplete copies after a crash may leave the database in an
-      unstable state. Removes the mutex for the write process. */
+  /** Moves the shadow files onto the main index files. A lock prevents
+      that incomplete moves after a crash may leave the database in an
+      unstable state. Publishes a new index snapshot for the readers to come.
+      Removes the mutex for the write process. */
   void write_commit(pid_t pid);
 
   /** Allocates a write lock if possible. Returns without doing anything
@@ -260,8 +266,8 @@ public:
   /** Read operations: --------------------------------------------------- */
 
   /** Request the index for a read operation and registers the reading process.
-      Reading the index files should be taking a quick copy, because if any process
-      is in this state, write_commits are blocked. */
+      The process reads from the current index snapshot. The snapshot stays in place
+      until the process has finished, hence write_commits need not wait for it. */
   void request_read_and_idx(
       pid_t pid, uint32 max_allowed_time, uint64 max_allowed_space, uint32 client_token);
 
@@ -34,7 +34,7 @@
 
 
 Dispatcher_Client::Dispatcher_Client(const std::string& dispatcher_share_name_)
-    : dispatcher_share_name(dispatcher_share_name_), socket("")
+    : dispatcher_share_name(dispatcher_share_name_), snapshot_version(0), socket("")
 {
   signal(SIGPIPE, SIG_IGN);
 
@@ -323,7 +323,10 @@ void Dispatcher_Client::request_read_and_idx(
 
     ack = ack_arrived();
     if (ack == Dispatcher::REQUEST_READ_AND_IDX)
+    {
+      snapshot_version = ack_arrived();
       return;
+    }
 
     millisleep(300);
   }
@@ -338,6 +341,12 @@ void Dispatcher_Client::request_read_and_idx(
 }
 
 
+std::string Dispatcher_Client::get_snapshot_dir() const
+{
+  return snapshot_version ? index_snapshot_dir(shadow_name, snapshot_version) : db_dir;
+}
+
+
 void Dispatcher_Client::read_idx_finished()
 {
   uint counter = 0;
@@ -448,6 +457,19 @@ void Dispatcher_Client::ping()
 }
 
 
+void Dispatcher_Client::report_space(uint64 peak_space)
+{
+  while (true)
+  {
+    send_message(Dispatcher::REPORT_SPACE, "Dispatcher_Client::report_space::1");
+    send_message(peak_space, "Dispatcher_Client::report_space::2");
+
+    if (ack_arrived())
+      return;
+  }
+}
+
+
 void Dispatcher_Client::terminate()
 {
   while (true)
@@ -66,8 +66,7 @@ class Dispatcher_Client
     /** Read operations: --------------------------------------------------- */
 
     /** Request the index for a read operation and registers the reading process.
-    Reading the index files should be taking a quick copy, because if any process
-    is in this state, write_commits are blocked. */
+    The index and data files shall then be opened from get_snapshot_dir(). */
     void request_read_and_idx(
         uint32 max_allowed_time, uint64 max_allowed_space, uint32 client_token, uint64 request_full_hash);
 
@@ -100,12 +99,20 @@ class Dispatcher_Client
     /** Called regularly to tell the dispatcher that this process is still alive */
     void ping();
 
+    /** Tells the dispatcher the peak heap usage of this process so far. */
+    void report_space(uint64 peak_space);
+
     const std::string& get_db_dir() { return db_dir; }
     const std::string& get_shadow_name() { return shadow_name; }
 
+    /** The directory with the index snapshot assigned by request_read_and_idx.
+    This is db_dir if the dispatcher has not assigned a snapshot. */
+    std::string get_snapshot_dir() const;
+
   private:
     std::string dispatcher_share_name;
     std::string db_dir, shadow_name;
+    uint32 snapshot_version;
     Unix_Socket socket;
 
     uint32 ack_arrived();
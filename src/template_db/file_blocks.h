@@ -240,7 +240,7 @@ private:
 
 public:
   File_Blocks(File_Blocks_Index_Base* index);
-  ~File_Blocks() {}
+  ~File_Blocks() { delete bloom_file; }
 
   Flat_Iterator flat_begin();
   Flat_Iterator flat_end();
@@ -252,6 +252,15 @@ public:
   template< typename Range_Iterator >
   File_Blocks_Range_Iterator< TIndex, Range_Iterator > range_end();
 
+  // Asks the kernel to read ahead the blocks of the given ranges, but at most max_bytes.
+  // Does not block, hence the reading can overlap with unrelated work of the caller.
+  template< typename Range_Iterator >
+  void prefetch(const Range_Iterator& begin, const Range_Iterator& end, uint64 max_bytes);
+
+  // Sums up the stored sizes of the blocks in the ranges from the index alone, up to limit
+  template< typename Range_Iterator >
+  uint64 range_size(const Range_Iterator& begin, const Range_Iterator& end, uint64 limit);
+
   Write_Iterator write_begin(const TIterator& begin, const TIterator& end, bool is_empty = false);
   Write_Iterator write_end();
 
@@ -265,16 +274,38 @@ public:
   uint read_count() const { return read_count_; }
   void reset_read_count() const { read_count_ = 0; }
 
-  Write_Iterator insert_block(const Write_Iterator& it, uint64* buf);
+  // If the file has id Bloom filters then bloom is stored as the slot of the new block.
+  // A null bloom stores an invalid slot, i.e. the block is never skipped by its ids.
   Write_Iterator insert_block(
-      const Write_Iterator& it, uint64* buf, uint32 payload_size, const TIndex& block_idx);
-  Write_Iterator replace_block(const Write_Iterator& it, uint64* buf);
+      const Write_Iterator& it, uint64* buf, uint32 summary = 0, const uint8* bloom = 0);
+  Write_Iterator insert_block(
+      const Write_Iterator& it, uint64* buf, uint32 payload_size, const TIndex& block_idx,
+      uint32 summary = 0, const uint8* bloom = 0);
+  Write_Iterator replace_block(
+      const Write_Iterator& it, uint64* buf, uint32 summary = 0, const uint8* bloom = 0);
   Write_Iterator replace_block(
-      Write_Iterator it, uint64* buf, uint32 payload_size, const TIndex& block_idx);
+      Write_Iterator it, uint64* buf, uint32 payload_size, const TIndex& block_idx,
+      uint32 summary = 0, const uint8* bloom = 0);
   Write_Iterator erase_block(Write_Iterator it);
   void erase_blocks(
       Write_Iterator& block_it, const Write_Iterator& it);
 
+  // False if the summaries in the index entries stem from an older file format and must be ignored
+  bool has_block_summaries() const
+  {
+    return wr_idx || rd_idx->get_file_format_version()
+        >= File_Blocks_Index_Structure_Params::MIN_VERSION_WITH_SUMMARIES;
+  }
+
+  // Creates the side file for the id Bloom filters if necessary. Only meaningful for writers.
+  void enable_id_blooms();
+  // Zero if the file has no id Bloom filters
+  uint32 id_bloom_size() const { return bloom_file ? Id_Bloom_Slot::size_of(block_size) : 0; }
+
+  // False if the summary or the id Bloom filter of the block rule out any match of the filter
+  template< typename File_Blocks_Iterator >
+  bool may_contain(const File_Blocks_Iterator& it, const Block_Filter& filter) const;
+
   const Readonly_File_Blocks_Index< TIndex >& get_rd_idx() const { return *rd_idx; }
   const Writeable_File_Blocks_Index< TIndex >& get_wr_idx() const { return *wr_idx; }
 
@@ -287,13 +318,16 @@ private:
   mutable uint read_count_;
 
   Raw_File data_file;
-  Void64_Pointer< uint64 > buffer;
+  Raw_File* bloom_file;
+  mutable std::vector< uint8 > bloom_buffer;
+  Block_Buffer buffer;
 
   template< typename File_Blocks_Iterator >
   uint64* read_block_(
       const File_Blocks_Iterator& it, uint64* buffer_, bool check_idx) const;
   uint32 allocate_block(uint32 data_size);
   void write_block(uint64* buf, uint32 uncompressed_size, uint32& data_size, uint32& pos);
+  void write_bloom(uint32 pos, const uint8* bloom);
 };
 
 
@@ -696,8 +730,47 @@ File_Blocks< TIndex, TIterator >::File_Blocks
      data_file(index_->get_data_file_name(),
 	       wr_idx ? O_RDWR|O_CREAT : O_RDONLY,
 	       S_666, "File_Blocks::File_Blocks::1"),
+     bloom_file(0),
      buffer(index_->get_block_size() * index_->get_compression_factor() * 2)      // increased buffer size for lz4
-{}
+{
+  // A writer must keep existing id Bloom filters up to date even if it does not use them
+  if (file_exists(index_->get_data_file_name() + Id_Bloom_Slot::file_suffix()))
+    bloom_file = new Raw_File(index_->get_data_file_name() + Id_Bloom_Slot::file_suffix(),
+        wr_idx ? O_RDWR : O_RDONLY, S_666, "File_Blocks::File_Blocks::2");
+}
+
+
+template< typename TIndex, typename TIterator >
+void File_Blocks< TIndex, TIterator >::enable_id_blooms()
+{
+  if (bloom_file || !wr_idx)
+    return;
+  // Slots of blocks written before stay invalid, hence these blocks are never skipped
+  bloom_file = new Raw_File(wr_idx->get_data_file_name() + Id_Bloom_Slot::file_suffix(), O_RDWR|O_CREAT, S_666,
+      "File_Blocks::enable_id_blooms::1");
+}
+
+
+template< typename TIndex, typename TIterator >
+template< typename File_Blocks_Iterator >
+bool File_Blocks< TIndex, TIterator >::may_contain(
+    const File_Blocks_Iterator& it, const Block_Filter& filter) const
+{
+  if (it.block().summary() && has_block_summaries() && !filter.may_contain(it.block().summary()))
+    return false;
+
+  const Block_Id_Filter* id_filter = filter.id_filter();
+  if (!bloom_file || !id_filter)
+    return true;
+
+  uint32 slot_size = id_bloom_size();
+  bloom_buffer.resize(slot_size);
+  // A short read means the slot has never been written
+  if (pread(bloom_file->fd(), &bloom_buffer[0], slot_size, (int64)it.block().pos() * slot_size)
+      != (ssize_t)slot_size)
+    return true;
+  return id_filter->may_contain_any(&bloom_buffer[0], slot_size);
+}
 
 
 template< typename TIndex, typename TIterator >
@@ -766,6 +839,52 @@ File_Blocks_Range_Iterator< TIndex, Range_Iterator > File_Blocks< TIndex, TItera
 }
 
 
+template< typename TIndex, typename TIterator >
+template< typename Range_Iterator >
+void File_Blocks< TIndex, TIterator >::prefetch(
+    const Range_Iterator& begin, const Range_Iterator& end, uint64 max_bytes)
+{
+  File_Blocks_Range_Iterator< TIndex, Range_Iterator > it = range_begin(begin, end);
+  File_Blocks_Range_Iterator< TIndex, Range_Iterator > it_end = range_end< Range_Iterator >();
+
+  // Adjacent blocks are coalesced into a single request
+  uint64 start = 0;
+  uint64 length = 0;
+  uint64 total = 0;
+  for (; !(it == it_end) && total < max_bytes; ++it)
+  {
+    uint64 pos = ((uint64)it.block().pos()) * block_size;
+    uint64 size = ((uint64)it.block().size()) * block_size;
+    if (pos != start + length)
+    {
+      if (length > 0)
+        posix_fadvise(data_file.fd(), start, length, POSIX_FADV_WILLNEED);
+      start = pos;
+      length = 0;
+    }
+    length += size;
+    total += size;
+  }
+  if (length > 0)
+    posix_fadvise(data_file.fd(), start, length, POSIX_FADV_WILLNEED);
+}
+
+
+template< typename TIndex, typename TIterator >
+template< typename Range_Iterator >
+uint64 File_Blocks< TIndex, TIterator >::range_size(
+    const Range_Iterator& begin, const Range_Iterator& end, uint64 limit)
+{
+  File_Blocks_Range_Iterator< TIndex, Range_Iterator > it = range_begin(begin, end);
+  File_Blocks_Range_Iterator< TIndex, Range_Iterator > it_end = range_end< Range_Iterator >();
+
+  uint64 total = 0;
+  for (; !(it == it_end) && total < limit; ++it)
+    total += ((uint64)it.block().size()) * block_size;
+  return total;
+}
+
+
 template< typename TIndex, typename TIterator >
 typename File_Blocks< TIndex, TIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator >::write_begin
@@ -817,7 +936,8 @@ uint64* File_Blocks< TIndex, TIterator >::read_block_
 {
   if (sigterm_status())
     throw File_Error(0, "-", "SIGTERM received");
-  
+
+  int inflated_size = 0;
   if (compression_method == File_Blocks_Index_Base::NO_COMPRESSION)
   {
     data_file.seek((int64)(block.pos()) * block_size, "File_Blocks::read_block::1");
@@ -830,7 +950,7 @@ uint64* File_Blocks< TIndex, TIterator >::read_block_
         rd_idx ? rd_idx->get_data_file_name() : wr_idx->get_data_file_name(), "File_Blocks::read_block::3");
     try
     {
-      Zlib_Inflate().decompress(
+      inflated_size = Zlib_Inflate().decompress(
           raw_block.ptr(), block_size * block.size(), buffer_, block_size * compression_factor);
     }
     catch (const Zlib_Inflate::Error& e)
@@ -850,7 +970,7 @@ uint64* File_Blocks< TIndex, TIterator >::read_block_
         rd_idx ? rd_idx->get_data_file_name() : wr_idx->get_data_file_name(), "File_Blocks::read_block::4");
     try
     {
-      LZ4_Inflate().decompress(
+      inflated_size = LZ4_Inflate().decompress(
           raw_block.ptr(), block_size * block.size(), buffer_, block_size * compression_factor);
     }
     catch (const LZ4_Inflate::Error& e)
@@ -873,6 +993,18 @@ uint64* File_Blocks< TIndex, TIterator >::read_block_
   }
   ++read_count_;
   ++global_read_counter();
+  if (block_read_statistics_enabled())
+  {
+    Block_Read_Statistics& stats = global_block_read_statistics()
+        [rd_idx ? rd_idx->get_data_file_name() : wr_idx->get_data_file_name()];
+    ++stats.blocks_read;
+    stats.bytes_read += block_size * block.size();
+    if (compression_method != File_Blocks_Index_Base::NO_COMPRESSION)
+    {
+      ++stats.blocks_decompressed;
+      stats.bytes_inflated += inflated_size;
+    }
+  }
   return buffer_;
 }
 
@@ -1014,19 +1146,35 @@ void File_Blocks< TIndex, TIterator >::write_block(uint64* buf, uint32 payload_s
 }
 
 
+template< typename TIndex, typename TIterator >
+void File_Blocks< TIndex, TIterator >::write_bloom(uint32 pos, const uint8* bloom)
+{
+  if (!bloom_file)
+    return;
+
+  uint32 slot_size = id_bloom_size();
+  std::vector< uint8 > slot(slot_size, 0);
+  if (bloom)
+    memcpy(&slot[0], bloom, slot_size);
+  bloom_file->seek(((int64)pos)*slot_size, "File_Blocks::write_bloom::1");
+  bloom_file->write(&slot[0], slot_size, "File_Blocks::write_bloom::2");
+}
+
+
 template< typename TIndex, typename TIterator >
 typename File_Blocks< TIndex, TIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator >::insert_block
-    (const Write_Iterator& it, uint64* buf)
+    (const Write_Iterator& it, uint64* buf, uint32 summary, const uint8* bloom)
 {
-  return insert_block(it, buf, *(uint32*)buf, TIndex((void*)(buf+1)));
+  return insert_block(it, buf, *(uint32*)buf, TIndex((void*)(buf+1)), summary, bloom);
 }
 
 
 template< typename TIndex, typename TIterator >
 typename File_Blocks< TIndex, TIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator >::insert_block
-    (const Write_Iterator& it, uint64* buf, uint32 payload_size, const TIndex& block_idx)
+    (const Write_Iterator& it, uint64* buf, uint32 payload_size, const TIndex& block_idx,
+     uint32 summary, const uint8* bloom)
 {
   if (buf == 0)
     return it;
@@ -1036,9 +1184,10 @@ typename File_Blocks< TIndex, TIterator >::Write_Iterator
   if (payload_size < block_size * compression_factor)
     memset(((uint8*)buf) + payload_size, 0, block_size * compression_factor - payload_size);
   write_block(buf, payload_size, data_size, pos);
+  write_bloom(pos, bloom);
 
   Write_Iterator return_it = it;
-  return_it.insert_block(*wr_idx, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size));
+  return_it.insert_block(*wr_idx, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, summary));
   return_it.is_empty = it.is_empty;
   return return_it;
 }
@@ -1047,16 +1196,17 @@ typename File_Blocks< TIndex, TIterator >::Write_Iterator
 template< typename TIndex, typename TIterator >
 typename File_Blocks< TIndex, TIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator >::replace_block
-    (const Write_Iterator& it, uint64* buf)
+    (const Write_Iterator& it, uint64* buf, uint32 summary, const uint8* bloom)
 {
-  return replace_block(it, buf, *(uint32*)buf, TIndex((void*)(buf+1)));
+  return replace_block(it, buf, *(uint32*)buf, TIndex((void*)(buf+1)), summary, bloom);
 }
 
 
 template< typename TIndex, typename TIterator >
 typename File_Blocks< TIndex, TIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator >::replace_block
-    (Write_Iterator it, uint64* buf, uint32 payload_size, const TIndex& block_idx)
+    (Write_Iterator it, uint64* buf, uint32 payload_size, const TIndex& block_idx,
+     uint32 summary, const uint8* bloom)
 {
   if (!buf)
     return erase_block(it);
@@ -1066,8 +1216,9 @@ typename File_Blocks< TIndex, TIterator >::Write_Iterator
     memset(((uint8*)buf) + payload_size, 0, block_size * compression_factor - payload_size);
   uint32 pos = 0;
   write_block(buf, payload_size, data_size, pos);
+  write_bloom(pos, bloom);
 
-  it.set_block(*wr_idx, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size));
+  it.set_block(*wr_idx, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, summary));
   return it;
 }
 
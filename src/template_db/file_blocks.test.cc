@@ -16,8 +16,11 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <ctime>
 #include <iostream>
 #include <list>
+#include <vector>
 
 #include <stdio.h>
 
@@ -764,8 +767,109 @@ void prepare_large_block(void* block, IntIndex index, uint32 block_size, uint32
 }
 
 
+/* Sample class for a fixed size TIndex */
+struct FixedIntIndex
+{
+  FixedIntIndex(uint32 i) : value(i) {}
+  FixedIntIndex(void* data) : value(*(uint32*)data) {}
+
+  static bool equal(void* lhs, void* rhs) { return *(uint32*)lhs == *(uint32*)rhs; }
+  bool less(void* rhs) const { return value < *(uint32*)rhs; }
+  bool leq(void* rhs) const { return value <= *(uint32*)rhs; }
+  bool equal(void* rhs) const { return value == *(uint32*)rhs; }
+
+  uint32 size_of() const { return 4; }
+  static constexpr uint32 const_size() { return 4; }
+  static uint32 size_of(void* data) { return 4; }
+
+  void to_data(void* data) const { *(uint32*)data = value; }
+
+  private:
+    uint32 value;
+};
+
+
+template< typename Index >
+clock_t seek_loop(
+    const std::vector< uint8 >& buf, File_Blocks_Index_Search_Tree< Index >* tree,
+    const std::vector< uint32 >& targets, std::vector< uint32 >& result)
+{
+  clock_t start = clock();
+  for (uint32 pass = 0; pass < 10; ++pass)
+  {
+    result.clear();
+    File_Blocks_Index_Iterator< Index > it(&buf[0], &buf[0] + buf.size(), tree);
+    for (std::vector< uint32 >::const_iterator target_it = targets.begin(); target_it != targets.end(); ++target_it)
+    {
+      it.seek(Index(*target_it));
+      result.push_back(it.is_end() ? 0xffffffffu : it.pos());
+    }
+  }
+  return clock() - start;
+}
+
+
+// Compares seeking scattered indexes by scanning the index with seeking through the search tree.
+int benchmark_seek()
+{
+  const uint32 num_entries = 1000000;
+
+  // Every hundredth index is spread over three segments
+  std::vector< uint8 > buf;
+  uint32 pos = 0;
+  for (uint32 i = 0; i < num_entries; ++i)
+  {
+    for (uint32 j = 0; j < (i % 100 == 50 ? 3 : 1); ++j)
+    {
+      buf.resize(buf.size() + 16);
+      uint32* entry = (uint32*)&buf[buf.size() - 16];
+      entry[0] = pos++;
+      entry[1] = 1;
+      entry[2] = 0;
+      FixedIntIndex(2*i).to_data(&entry[3]);
+    }
+  }
+
+  clock_t start = clock();
+  File_Blocks_Index_Search_Tree< FixedIntIndex > tree;
+  tree.reset(&buf[0], &buf[0] + buf.size());
+  tree.usable();
+  std::cout<<buf.size()/16<<" index entries\n"
+      <<"build search tree: "<<double(clock() - start)/CLOCKS_PER_SEC<<" s\n";
+
+  uint32 seed = 1;
+  for (uint32 num_targets = 100; num_targets <= 100000; num_targets *= 10)
+  {
+    std::vector< uint32 > targets;
+    for (uint32 i = 0; i < num_targets; ++i)
+    {
+      seed = seed*1103515245 + 12345;
+      targets.push_back((seed>>8) % (2*num_entries + 100));
+    }
+    std::sort(targets.begin(), targets.end());
+
+    std::vector< uint32 > scanned;
+    clock_t scan_time = seek_loop< FixedIntIndex >(buf, 0, targets, scanned);
+    std::vector< uint32 > searched;
+    clock_t search_time = seek_loop< FixedIntIndex >(buf, &tree, targets, searched);
+
+    std::cout<<num_targets<<" seeks, 10 passes: "
+        <<"scan "<<double(scan_time)/CLOCKS_PER_SEC<<" s, "
+        <<"search tree "<<double(search_time)/CLOCKS_PER_SEC<<" s\n";
+    if (scanned != searched)
+    {
+      std::cout<<"Results differ.\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int main(int argc, char* args[])
 {
+  if (argc > 1 && std::string(args[1]) == "benchmark")
+    return benchmark_seek();
+
   std::string test_to_execute;
   if (argc > 1)
     test_to_execute = args[1];
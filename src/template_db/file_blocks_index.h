@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <list>
 #include <string>
 #include <vector>
@@ -42,12 +43,14 @@ struct File_Block_Index_Entry
   static const int SEGMENT = 3;
   static const int LAST_SEGMENT = 4;
 
-  File_Block_Index_Entry(const Index& index_, uint32 pos_, uint32 size_)
-    : index(index_), pos(pos_), size(size_) {}
+  File_Block_Index_Entry(const Index& index_, uint32 pos_, uint32 size_, uint32 summary_ = 0)
+    : index(index_), pos(pos_), size(size_), summary(summary_) {}
 
   Index index;
   uint32 pos;
   uint32 size;
+  // Condensed description of the block's objects, see Block_Summary. Zero means unknown.
+  uint32 summary;
 };
 
 
@@ -131,6 +134,60 @@ struct File_Blocks_Index_Structure_Params
   uint32 block_count;
 
   static const int FILE_FORMAT_VERSION = 7600;
+  // Older index files may carry arbitrary values in the summary field
+  static const int MIN_VERSION_WITH_SUMMARIES = 7600;
+};
+
+
+/* Search structure over the entries of an index buffer, built on first use.
+ * Only the first entry of each run of entries with the same index is a key.
+ * The keys are kept in Eytzinger order, i.e. as an implicit binary tree stored breadth-first,
+ * such that the upper levels of the tree share few cache lines. Fixed size indexes are copied
+ * into a contiguous array, variable size indexes are compared in place.
+ * Each node carries the positions seek() ends at, hence a search touches no other array. */
+template< typename Index >
+struct File_Blocks_Index_Search_Tree
+{
+public:
+  File_Blocks_Index_Search_Tree() : begin(0), end(0), built(false) {}
+
+  void reset(const uint8* begin_, const uint8* end_);
+
+  // Whether the index buffer is large enough to profit from the search structure
+  bool usable();
+
+  // Returns the position File_Blocks_Index_Iterator::seek must end at
+  // for a target strictly greater than the index of some entry in the buffer.
+  const uint8* seek(const Index& target) const;
+
+  static const uint32 MIN_ENTRIES = 64;
+  static const uint32 MAX_SCAN_STEPS = 64;
+
+private:
+  struct Node
+  {
+    // Offset of the first entry of the run
+    uint32 found;
+    // Offset to end at if the target lies between the previous run and this run
+    uint32 not_found;
+  };
+
+  const uint8* begin;
+  const uint8* end;
+  bool built;
+
+  // Node 0 is unused except for not_found that applies to targets beyond the last run
+  std::vector< Node > nodes;
+  std::vector< uint8 > keys;
+
+  void build();
+  uint32 fill_tree(const std::vector< uint32 >& run_offsets, const std::vector< bool >& run_is_segment,
+      uint32 rank, uint32 node);
+  void* key(uint32 node) const
+  {
+    return Index::const_size() ? (void*)&keys[node*Index::const_size()]
+        : (void*)(begin + nodes[node].found + 12);
+  }
 };
 
 
@@ -138,9 +195,11 @@ template< typename Index >
 struct File_Blocks_Index_Iterator
 {
 public:
-  File_Blocks_Index_Iterator(const uint8* ptr_, const uint8* end_) : ptr(ptr_), end(end_), idx(0) {}
+  File_Blocks_Index_Iterator(const uint8* ptr_, const uint8* end_,
+      File_Blocks_Index_Search_Tree< Index >* tree_ = 0) : ptr(ptr_), end(end_), tree(tree_), idx(0) {}
   ~File_Blocks_Index_Iterator() { delete idx; }
-  File_Blocks_Index_Iterator(const File_Blocks_Index_Iterator& rhs) : ptr(rhs.ptr), end(rhs.end), idx(0) {}
+  File_Blocks_Index_Iterator(const File_Blocks_Index_Iterator& rhs)
+      : ptr(rhs.ptr), end(rhs.end), tree(rhs.tree), idx(0) {}
   File_Blocks_Index_Iterator& operator=(const File_Blocks_Index_Iterator& rhs)
   {
     if (ptr != rhs.ptr)
@@ -150,6 +209,7 @@ public:
       ptr = rhs.ptr;
       end = rhs.end;
     }
+    tree = rhs.tree;
     return *this;
   }
 
@@ -181,10 +241,12 @@ public:
   }
   uint32 pos() const { return *(uint32*)ptr; }
   uint32 size() const { return *(uint32*)(ptr + 4); }
+  uint32 summary() const { return *(uint32*)(ptr + 8); }
 
 private:
   const uint8* ptr;
   const uint8* end;
+  File_Blocks_Index_Search_Tree< Index >* tree;
   mutable Index* idx;
 };
 
@@ -210,12 +272,13 @@ public:
   virtual bool empty() const { return params.empty_; }
   File_Blocks_Index_Iterator< Index > begin()
   { posix_madvise((void*)idx_file.header(), idx_file.size(), POSIX_MADV_WILLNEED);
-    return File_Blocks_Index_Iterator< Index >(idx_file.begin(), idx_file.end()); }
+    return File_Blocks_Index_Iterator< Index >(idx_file.begin(), idx_file.end(), &search_tree); }
   File_Blocks_Index_Iterator< Index > end()
-  { return File_Blocks_Index_Iterator< Index >(idx_file.end(), idx_file.end()); }
+  { return File_Blocks_Index_Iterator< Index >(idx_file.end(), idx_file.end(), &search_tree); }
 
 private:
   File_Blocks_Index_Mmap idx_file;
+  File_Blocks_Index_Search_Tree< Index > search_tree;
   std::string data_file_name;
   File_Blocks_Index_Structure_Params params;
   std::string file_name_extension_;
@@ -255,18 +318,20 @@ public:
     if (!idx_file_buf_valid)
     {
       idx_file.rebuild_index_buf(params, block_list);
-      idx_file_buf_valid = true;      
+      search_tree.reset(idx_file.begin(), idx_file.end());
+      idx_file_buf_valid = true;
     }
-    return File_Blocks_Index_Iterator< Index >(idx_file.begin(), idx_file.end());
+    return File_Blocks_Index_Iterator< Index >(idx_file.begin(), idx_file.end(), &search_tree);
   }
   File_Blocks_Index_Iterator< Index > end()
-  { 
+  {
     if (!idx_file_buf_valid)
     {
       idx_file.rebuild_index_buf(params, block_list);
-      idx_file_buf_valid = true;      
+      search_tree.reset(idx_file.begin(), idx_file.end());
+      idx_file_buf_valid = true;
     }
-    return File_Blocks_Index_Iterator< Index >(idx_file.end(), idx_file.end());
+    return File_Blocks_Index_Iterator< Index >(idx_file.end(), idx_file.end(), &search_tree);
   }
 
   const typename std::list< File_Block_Index_Entry< Index > >::iterator wr_begin() { return block_list.begin(); }
@@ -293,6 +358,7 @@ public:
 
 private:
   File_Blocks_Index_File idx_file;
+  File_Blocks_Index_Search_Tree< Index > search_tree;
   bool idx_file_buf_valid;
   std::string empty_index_file_name;
   std::string data_file_name;
@@ -330,23 +396,112 @@ inline uint64 file_size_of(const std::string& data_file_name)
 }
 
 
+/** Implementation File_Blocks_Index_Search_Tree: ---------------------------*/
+
+template< typename Index >
+void File_Blocks_Index_Search_Tree< Index >::reset(const uint8* begin_, const uint8* end_)
+{
+  begin = begin_;
+  end = end_;
+  built = false;
+  nodes.clear();
+  keys.clear();
+}
+
+
+template< typename Index >
+bool File_Blocks_Index_Search_Tree< Index >::usable()
+{
+  if (!built)
+    build();
+  return !nodes.empty();
+}
+
+
+// The target belongs to the block before the run it is missing from,
+// unless that block is one of the segments of a different index
 template< typename Index >
-const uint8* binary_seek(const uint8* begin, const uint8* end, const Index& target)
+void File_Blocks_Index_Search_Tree< Index >::build()
 {
-  auto min = begin;
-  auto max = end;
-  while (max - min > 2*(Index::const_size() + 12))
+  built = true;
+  if (!begin)
+    return;
+
+  std::vector< uint32 > run_offsets;
+  std::vector< bool > run_is_segment;
+  const uint8* ptr = begin;
+  while (ptr < end)
   {
-    auto middle = min + ((max - min)/(Index::const_size() + 12)/2*(Index::const_size() + 12));
-    if (target.less((void*)(middle+12)))
-      max = middle;
+    if (!run_offsets.empty() && Index::equal((void*)(begin + run_offsets.back() + 12), (void*)(ptr + 12)))
+      run_is_segment.back() = true;
     else
-      min = middle;
+    {
+      run_offsets.push_back(ptr - begin);
+      run_is_segment.push_back(false);
+    }
+    File_Blocks_Index_File::inc< Index >(ptr);
+  }
+  if (run_offsets.size() < MIN_ENTRIES)
+    return;
+
+  nodes.resize(run_offsets.size() + 1);
+  fill_tree(run_offsets, run_is_segment, 0, 1);
+  nodes[0].found = end - begin;
+  nodes[0].not_found = run_is_segment.back() ? end - begin : run_offsets.back();
+
+  if (Index::const_size())
+  {
+    keys.resize(nodes.size() * Index::const_size());
+    for (uint32 node = 1; node < nodes.size(); ++node)
+      memcpy(&keys[node*Index::const_size()], begin + nodes[node].found + 12, Index::const_size());
+  }
+}
+
+
+// An in-order traversal of the implicit tree visits the runs in ascending order
+template< typename Index >
+uint32 File_Blocks_Index_Search_Tree< Index >::fill_tree(
+    const std::vector< uint32 >& run_offsets, const std::vector< bool >& run_is_segment,
+    uint32 rank, uint32 node)
+{
+  if (node < nodes.size())
+  {
+    rank = fill_tree(run_offsets, run_is_segment, rank, 2*node);
+    nodes[node].found = run_offsets[rank];
+    if (rank == 0 || run_is_segment[rank-1])
+      nodes[node].not_found = run_offsets[rank];
+    else
+      nodes[node].not_found = run_offsets[rank-1];
+    ++rank;
+    rank = fill_tree(run_offsets, run_is_segment, rank, 2*node + 1);
+  }
+  return rank;
+}
+
+
+template< typename Index >
+const uint8* File_Blocks_Index_Search_Tree< Index >::seek(const Index& target) const
+{
+  // Descend to the leftmost run whose index is not less than target.
+  // The bits of the node number record the path, the trailing ones are the final right turns.
+  uint32 num_nodes = nodes.size();
+  uint32 node = 1;
+  while (node < num_nodes)
+  {
+    if (Index::const_size() && 16*node < num_nodes)
+      __builtin_prefetch(&keys[16*node*Index::const_size()]);
+    node = 2*node + !target.leq(key(node));
   }
-  return min;
+  node >>= __builtin_ffs(~node);
+
+  if (node && target.equal(key(node)))
+    return begin + nodes[node].found;
+  return begin + nodes[node].not_found;
 }
 
 
+/** Implementation File_Blocks_Index_Iterator: ------------------------------*/
+
 template< typename Index >
 void File_Blocks_Index_Iterator< Index >::seek(const Index& target)
 {
@@ -355,19 +510,15 @@ void File_Blocks_Index_Iterator< Index >::seek(const Index& target)
 
   if (ptr == end || target.less((void*)(ptr+12)))
     return;
-  if (Index::const_size() && ((end - ptr) > 32*(Index::const_size() + 12))
-      && !target.less((void*)(ptr + 32*(Index::const_size() + 12) + 12)))
+  uint32 steps = 0;
+  while (!target.equal((void*)(ptr+12)))
   {
-    decltype(ptr) next = binary_seek(ptr, end, target);
-    if (next != end)
+    // Nearby targets are found faster by scanning, far away targets by the search tree
+    if (++steps > File_Blocks_Index_Search_Tree< Index >::MAX_SCAN_STEPS && tree && tree->usable())
     {
-      while (ptr < next && target.equal((void*)(next+12)))
-        next -= (Index::const_size() + 12);
+      ptr = tree->seek(target);
+      return;
     }
-    ptr = next;
-  }
-  while (!target.equal((void*)(ptr+12)))
-  {
     decltype(ptr) next = ptr+12;
     next += Index::size_of((void*)next);
     bool is_segment = false;
@@ -398,7 +549,11 @@ inline File_Blocks_Index_File::File_Blocks_Index_File(
 {
   try
   {
-    Raw_File source_file(file_name, O_RDONLY, S_666, "File_Blocks_Index::File_Blocks_Index::3");
+    // Without a shadow file the writer starts from the main file
+    std::string source_name = file_name;
+    if (use_shadow && !file_exists(file_name))
+      source_name = file_name.substr(0, file_name.size() - file_prop.get_shadow_suffix().size());
+    Raw_File source_file(source_name, O_RDONLY, S_666, "File_Blocks_Index::File_Blocks_Index::3");
 
     // read index file
     size_ = source_file.size("File_Blocks_Index::File_Blocks_Index::4");
@@ -488,7 +643,10 @@ Readonly_File_Blocks_Index< Index >::Readonly_File_Blocks_Index(
       data_file_name(db_dir + file_prop.get_file_name_trunk()
           + file_name_extension + file_prop.get_data_suffix()),
       params(file_prop, file_name_extension, USE_DEFAULT, idx_file, file_size_of(data_file_name)), 
-      file_name_extension_(file_name_extension) {}
+      file_name_extension_(file_name_extension)
+{
+  search_tree.reset(idx_file.begin(), idx_file.end());
+}
 
 
 template< class Index >
@@ -505,6 +663,7 @@ Writeable_File_Blocks_Index< Index >::Writeable_File_Blocks_Index
      params(file_prop, file_name_extension, compression_method_, idx_file, file_size_of(data_file_name)), 
      file_name_extension_(file_name_extension), void_blocks_initialized(false)
 {
+  search_tree.reset(idx_file.begin(), idx_file.end());
   init_blocks();
   init_void_blocks();
 }
@@ -522,7 +681,9 @@ void Writeable_File_Blocks_Index< Index >::init_blocks()
     {
       Index index((void*)(ptr + 12));
       File_Block_Index_Entry< Index >
-          entry(index, *(uint32*)(ptr), *(uint32*)(ptr + 4));
+          entry(index, *(uint32*)(ptr), *(uint32*)(ptr + 4),
+              params.file_format_version >= File_Blocks_Index_Structure_Params::MIN_VERSION_WITH_SUMMARIES
+              ? *(uint32*)(ptr + 8) : 0);
       if (entry.pos >= params.block_count)
         throw File_Error(0, idx_file.file_name, "File_Blocks_Index: bad pos in index file");
       if (entry.pos + entry.size > params.block_count)
@@ -642,7 +803,7 @@ void File_Blocks_Index_File::rebuild_index_buf(
     pos += 4;
     *(uint32*)(buf.ptr+pos) = it->size;
     pos += 4;
-    *(uint32*)(buf.ptr+pos) = 0;
+    *(uint32*)(buf.ptr+pos) = it->summary;
     pos += 4;
     it->index.to_data(buf.ptr+pos);
     pos += it->index.size_of();
@@ -140,8 +140,12 @@ inline Random_File_Index::Random_File_Index
 
   try
   {
+    // Without a shadow file the writer starts from the main file
+    std::string source_name = index_file_name;
+    if (use_shadow && !file_exists(index_file_name))
+      source_name = index_file_name.substr(0, index_file_name.size() - file_prop.get_shadow_suffix().size());
     Raw_File source_file
-        (index_file_name, writeable ? O_RDONLY|O_CREAT : O_RDONLY, S_666,
+        (source_name, writeable && source_name == index_file_name ? O_RDONLY|O_CREAT : O_RDONLY, S_666,
 	 "Random_File:6");
 
     // read index file
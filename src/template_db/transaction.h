@@ -40,9 +40,12 @@ class Transaction
 class Nonsynced_Transaction : public Transaction
 {
   public:
+    /* If snapshot_dir is set then the index and data files are opened from there
+     * while get_db_dir() still refers to the database directory. */
     Nonsynced_Transaction
         (bool writeable, bool use_shadow,
-	 const std::string& db_dir, const std::string& file_name_extension);
+	 const std::string& db_dir, const std::string& file_name_extension,
+	 const std::string& snapshot_dir = "");
     virtual ~Nonsynced_Transaction();
 
     File_Blocks_Index_Base* data_index(const File_Properties*);
@@ -57,19 +60,24 @@ class Nonsynced_Transaction : public Transaction
     std::map< const File_Properties*, Random_File_Index* >
       random_files;
     bool writeable, use_shadow;
-    std::string file_name_extension, db_dir;
+    std::string file_name_extension, db_dir, snapshot_dir;
 };
 
 
 inline Nonsynced_Transaction::Nonsynced_Transaction
     (bool writeable_, bool use_shadow_,
-     const std::string& db_dir_, const std::string& file_name_extension_)
+     const std::string& db_dir_, const std::string& file_name_extension_,
+     const std::string& snapshot_dir_)
   : writeable(writeable_), use_shadow(use_shadow_),
-    file_name_extension(file_name_extension_), db_dir(db_dir_)
+    file_name_extension(file_name_extension_), db_dir(db_dir_), snapshot_dir(snapshot_dir_)
 {
   signal(SIGTERM, sigterm);
   if (!db_dir.empty() && db_dir[db_dir.size()-1] != '/')
     db_dir += "/";
+  if (snapshot_dir.empty())
+    snapshot_dir = db_dir;
+  else if (snapshot_dir[snapshot_dir.size()-1] != '/')
+    snapshot_dir += "/";
 }
 
 
@@ -101,7 +109,7 @@ inline File_Blocks_Index_Base* Nonsynced_Transaction::data_index
     return it->second;
 
   File_Blocks_Index_Base* data_index = fp->new_data_index
-      (writeable, use_shadow, db_dir, file_name_extension);
+      (writeable, use_shadow, snapshot_dir, file_name_extension);
   if (data_index != 0)
     data_files[fp] = data_index;
   return data_index;
@@ -115,7 +123,7 @@ inline Random_File_Index* Nonsynced_Transaction::random_index(const File_Propert
   if (it != random_files.end())
     return it->second;
 
-  random_files[fp] = new Random_File_Index(*fp, writeable, use_shadow, db_dir, file_name_extension);
+  random_files[fp] = new Random_File_Index(*fp, writeable, use_shadow, snapshot_dir, file_name_extension);
   return random_files[fp];
 }
 
@@ -18,6 +18,7 @@
 
 #include "dispatcher.h"
 
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -81,17 +82,21 @@ std::vector< bool > Idx_Footprints::total_footprint() const
 
 
 Transaction_Insulator::Transaction_Insulator(
-    const std::string& db_dir, const std::vector< File_Properties* >& controlled_files_)
-    : db_dir_(db_dir), controlled_files(controlled_files_),
-    data_footprints(controlled_files_.size()), map_footprints(controlled_files_.size())
+    const std::string& db_dir, const std::string& shadow_name_,
+    const std::vector< File_Properties* >& controlled_files_)
+    : db_dir_(db_dir), shadow_name(shadow_name_), controlled_files(controlled_files_),
+    data_footprints(controlled_files_.size()), map_footprints(controlled_files_.size()),
+    snapshot_version(0), last_snapshot_version(0)
 {
   // get the absolute pathname of the current directory
   if (db_dir.substr(0, 1) != "/")
     db_dir_ = getcwd() + db_dir;
+  if (shadow_name.substr(0, 1) != "/")
+    shadow_name = getcwd() + shadow_name;
 }
 
 
-void Transaction_Insulator::request_read_and_idx(pid_t pid)
+uint32 Transaction_Insulator::request_read_and_idx(pid_t pid)
 {
   for (std::vector< Idx_Footprints >::iterator it(data_footprints.begin());
       it != data_footprints.end(); ++it)
@@ -99,6 +104,9 @@ void Transaction_Insulator::request_read_and_idx(pid_t pid)
   for (std::vector< Idx_Footprints >::iterator it(map_footprints.begin());
       it != map_footprints.end(); ++it)
     it->register_pid(pid);
+
+  snapshot_per_pid[pid] = snapshot_version;
+  return snapshot_version;
 }
 
 
@@ -110,38 +118,156 @@ void Transaction_Insulator::read_finished(pid_t pid)
   for (std::vector< Idx_Footprints >::iterator it(map_footprints.begin());
       it != map_footprints.end(); ++it)
     it->unregister_pid(pid);
+
+  if (snapshot_per_pid.erase(pid))
+    remove_unused_snapshots();
 }
 
 
-void Transaction_Insulator::copy_shadows_to_mains()
+uint32 Transaction_Insulator::snapshot_of(pid_t pid) const
 {
-  for (auto it = controlled_files.begin(); it != controlled_files.end(); ++it)
+  std::map< pid_t, uint32 >::const_iterator it = snapshot_per_pid.find(pid);
+  return it == snapshot_per_pid.end() ? 0 : it->second;
+}
+
+
+namespace
+{
+  void remove_snapshot_dir(const std::string& dir)
   {
-    copy_file(
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix() + (*it)->get_index_suffix()
-        + (*it)->get_shadow_suffix(),
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix() + (*it)->get_index_suffix());
-    copy_file(
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix() + (*it)->get_index_suffix()
-        + (*it)->get_shadow_suffix(),
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix() + (*it)->get_index_suffix());
+    DIR* dp = opendir(dir.c_str());
+    if (!dp)
+      return;
+    struct dirent* ep;
+    while ((ep = readdir(dp)))
+    {
+      std::string name = ep->d_name;
+      if (name != "." && name != "..")
+        remove((dir + name).c_str());
+    }
+    closedir(dp);
+    rmdir(dir.c_str());
+  }
+
+
+  void link_into_snapshot(const std::string& db_dir, const std::string& dest_dir, const std::string& name)
+  {
+    if (!file_exists(db_dir + name))
+      return;
+    if (link((db_dir + name).c_str(), (dest_dir + name).c_str()))
+      throw File_Error(errno, dest_dir + name, "Transaction_Insulator::publish_snapshot::2");
+  }
+}
+
+
+void Transaction_Insulator::publish_snapshot()
+{
+  std::string dir = index_snapshot_dir(shadow_name, last_snapshot_version + 1);
+  try
+  {
+    remove_snapshot_dir(dir);
+    if (mkdir(dir.c_str(), S_666|S_IXUSR|S_IXGRP|S_IXOTH))
+      throw File_Error(errno, dir, "Transaction_Insulator::publish_snapshot::1");
+
+    for (std::vector< File_Properties* >::const_iterator it(controlled_files.begin());
+        it != controlled_files.end(); ++it)
+    {
+      std::string data_base = (*it)->get_file_name_trunk() + (*it)->get_data_suffix();
+      if (file_exists(db_dir() + data_base + (*it)->get_index_suffix()))
+      {
+        link_into_snapshot(db_dir(), dir, data_base);
+        link_into_snapshot(db_dir(), dir, data_base + Id_Bloom_Slot::file_suffix());
+        link_into_snapshot(db_dir(), dir, data_base + (*it)->get_index_suffix());
+      }
+      std::string id_base = (*it)->get_file_name_trunk() + (*it)->get_id_suffix();
+      if (file_exists(db_dir() + id_base + (*it)->get_index_suffix()))
+      {
+        link_into_snapshot(db_dir(), dir, id_base);
+        link_into_snapshot(db_dir(), dir, id_base + (*it)->get_index_suffix());
+      }
+    }
+  }
+  catch (File_Error e)
+  {
+    // Without a snapshot the readers fall back to the main files
+    std::cerr<<"File_Error "<<e.error_number<<' '<<strerror(e.error_number)<<' '<<e.filename<<' '<<e.origin<<'\n';
+    remove_snapshot_dir(dir);
+    snapshot_version = 0;
+    remove_unused_snapshots();
+    return;
+  }
+
+  snapshot_version = ++last_snapshot_version;
+  remove_unused_snapshots();
+}
+
+
+void Transaction_Insulator::remove_unused_snapshots()
+{
+  std::set< uint32 > used;
+  for (std::map< pid_t, uint32 >::const_iterator it = snapshot_per_pid.begin(); it != snapshot_per_pid.end(); ++it)
+    used.insert(it->second);
+  used.insert(snapshot_version);
+
+  for (std::set< uint32 >::iterator it = published_snapshots.begin(); it != published_snapshots.end(); )
+  {
+    if (used.find(*it) == used.end())
+    {
+      remove_snapshot_dir(index_snapshot_dir(shadow_name, *it));
+      published_snapshots.erase(it++);
+    }
+    else
+      ++it;
+  }
+  if (snapshot_version)
+    published_snapshots.insert(snapshot_version);
+}
+
+
+void Transaction_Insulator::remove_snapshots()
+{
+  std::string::size_type slash_pos = shadow_name.rfind('/');
+  std::string dir = shadow_name.substr(0, slash_pos + 1);
+  std::string prefix = shadow_name.substr(slash_pos + 1) + ".snapshot.";
+
+  DIR* dp = opendir(dir.c_str());
+  if (!dp)
+    return;
+  std::vector< std::string > found;
+  struct dirent* ep;
+  while ((ep = readdir(dp)))
+  {
+    std::string name = ep->d_name;
+    if (name.substr(0, prefix.size()) == prefix)
+      found.push_back(dir + name + "/");
   }
+  closedir(dp);
+
+  for (std::vector< std::string >::const_iterator it = found.begin(); it != found.end(); ++it)
+    remove_snapshot_dir(*it);
+
+  snapshot_version = 0;
+  snapshot_per_pid.clear();
+  published_snapshots.clear();
 }
 
 
-void Transaction_Insulator::copy_mains_to_shadows()
+// Each shadow index replaces its main index by a rename, hence the commit takes constant time
+// in the size of the indexes. The replaced indexes live on in the snapshots of their readers.
+// Writers start from the main index where there is no shadow index.
+void Transaction_Insulator::move_shadows_to_mains()
 {
   for (std::vector< File_Properties* >::const_iterator it(controlled_files.begin());
       it != controlled_files.end(); ++it)
   {
-    copy_file(
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix() + (*it)->get_index_suffix(),
+    move_file(
         db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix() + (*it)->get_index_suffix()
-            + (*it)->get_shadow_suffix());
-    copy_file(
-        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix() + (*it)->get_index_suffix(),
+        + (*it)->get_shadow_suffix(),
+        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix() + (*it)->get_index_suffix());
+    move_file(
         db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix() + (*it)->get_index_suffix()
-            + (*it)->get_shadow_suffix());
+        + (*it)->get_shadow_suffix(),
+        db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix() + (*it)->get_index_suffix());
   }
 }
 
@@ -156,6 +282,11 @@ void Transaction_Insulator::move_migrated_files_in_place()
     if (file_exists(src_base + (*it)->get_index_suffix()))
     {
       force_link_file(src_base, dest_base);
+      // Bloom filters of the old data file would refer to the wrong blocks
+      if (file_exists(src_base + Id_Bloom_Slot::file_suffix()))
+        force_link_file(src_base + Id_Bloom_Slot::file_suffix(), dest_base + Id_Bloom_Slot::file_suffix());
+      else
+        remove((dest_base + Id_Bloom_Slot::file_suffix()).c_str());
       force_link_file(src_base + (*it)->get_index_suffix(), dest_base + (*it)->get_index_suffix());
     }
 
@@ -194,6 +325,8 @@ void Transaction_Insulator::remove_migrated()
       it != controlled_files.end(); ++it)
   {
     remove((db_dir() + (*it)->get_file_name_trunk() + ".next" + (*it)->get_data_suffix()).c_str());
+    remove((db_dir() + (*it)->get_file_name_trunk() + ".next" + (*it)->get_data_suffix()
+            + Id_Bloom_Slot::file_suffix()).c_str());
     remove((db_dir() + (*it)->get_file_name_trunk() + ".next" + (*it)->get_data_suffix()
             + (*it)->get_index_suffix()).c_str());
     remove((db_dir() + (*it)->get_file_name_trunk() + ".next" + (*it)->get_id_suffix()).c_str());
@@ -323,8 +456,7 @@ void Transaction_Insulator::write_index_of_empty_blocks()
   {
     if (file_exists(db_dir() + controlled_files[i]->get_file_name_trunk()
         + controlled_files[i]->get_data_suffix()
-	+ controlled_files[i]->get_index_suffix()
-	+ controlled_files[i]->get_shadow_suffix()))
+	+ controlled_files[i]->get_index_suffix()))
     {
       write_to_index_empty_file_data
           (data_footprints[i].total_footprint(),
@@ -334,8 +466,7 @@ void Transaction_Insulator::write_index_of_empty_blocks()
     }
     if (file_exists(db_dir() + controlled_files[i]->get_file_name_trunk()
         + controlled_files[i]->get_id_suffix()
-	+ controlled_files[i]->get_index_suffix()
-	+ controlled_files[i]->get_shadow_suffix()))
+	+ controlled_files[i]->get_index_suffix()))
     {
       write_to_index_empty_file_ids
           (map_footprints[i].total_footprint(),
@@ -24,6 +24,7 @@
 
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 
@@ -44,16 +45,31 @@ class Idx_Footprints
 };
 
 
+/* Directory with hard links to the index and data files of the given snapshot version.
+ * The links keep each version readable and unchanged for the readers that have started on it
+ * while later commits replace the index files in the database directory. */
+inline std::string index_snapshot_dir(const std::string& shadow_name, uint32 version)
+{
+  return shadow_name + ".snapshot." + std::to_string(version) + "/";
+}
+
+
 class Transaction_Insulator
 {
 public:
-  Transaction_Insulator(const std::string& db_dir, const std::vector< File_Properties* >& controlled_files_);
-  void request_read_and_idx(pid_t pid);
+  Transaction_Insulator(
+      const std::string& db_dir, const std::string& shadow_name,
+      const std::vector< File_Properties* >& controlled_files_);
+  uint32 request_read_and_idx(pid_t pid);
   void read_finished(pid_t pid);
   std::vector< ::pid_t > registered_pids() const;
 
-  void copy_shadows_to_mains();
-  void copy_mains_to_shadows();
+  // Returns the snapshot version the process reads from, zero if it reads the main files
+  uint32 snapshot_of(pid_t pid) const;
+  void publish_snapshot();
+  void remove_snapshots();
+
+  void move_shadows_to_mains();
   void remove_shadows();
   void remove_migrated();
   void set_current_footprints();
@@ -64,9 +80,16 @@ public:
 
 private:
   std::string db_dir_;
+  std::string shadow_name;
   std::vector< File_Properties* > controlled_files;
   std::vector< Idx_Footprints > data_footprints;
   std::vector< Idx_Footprints > map_footprints;
+  uint32 snapshot_version;
+  uint32 last_snapshot_version;
+  std::set< uint32 > published_snapshots;
+  std::map< pid_t, uint32 > snapshot_per_pid;
+
+  void remove_unused_snapshots();
 };
 
 
@@ -16,7 +16,9 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/un.h>
 #include "types.h"
 
@@ -62,6 +64,15 @@ void force_link_file(const std::string& source, const std::string& dest)
 }
 
 
+void move_file(const std::string& source, const std::string& dest)
+{
+  if (!file_exists(source))
+    return;
+  if (rename(source.c_str(), dest.c_str()))
+    throw File_Error(errno, source, "move_file:1");
+}
+
+
 int& global_read_counter()
 {
   static int counter = 0;
@@ -69,6 +80,20 @@ int& global_read_counter()
 }
 
 
+bool& block_read_statistics_enabled()
+{
+  static bool enabled = false;
+  return enabled;
+}
+
+
+std::map< std::string, Block_Read_Statistics >& global_block_read_statistics()
+{
+  static std::map< std::string, Block_Read_Statistics > statistics;
+  return statistics;
+}
+
+
 Signal_Status& sigterm_status()
 {
   static Signal_Status status = Signal_Status::absent;
@@ -146,3 +171,158 @@ Unix_Socket::~Unix_Socket()
   if (socket_descriptor != -1)
     close(socket_descriptor);
 }
+
+
+namespace
+{
+  const uint MAX_FREE_BUFFERS = 16;
+  const uint64 HUGE_PAGE_SIZE = 2*1024*1024;
+
+  // Same value as in the kernel headers, to not depend on libnuma
+  const int MPOL_PREFERRED_ = 1;
+
+  int current_numa_node()
+  {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, 0) == 0)
+      return node;
+#endif
+    return -1;
+  }
+
+  void prefer_numa_node(void* ptr, uint64 size, int node)
+  {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || node >= 64)
+      return;
+    unsigned long nodemask = 1ul<<node;
+    // A failure only costs locality, hence it is ignored
+    syscall(SYS_mbind, ptr, size, MPOL_PREFERRED_, &nodemask, 64, 0);
+#endif
+  }
+}
+
+
+Block_Buffer_Pool& Block_Buffer_Pool::instance()
+{
+  static Block_Buffer_Pool* pool = new Block_Buffer_Pool();
+  return *pool;
+}
+
+
+Block_Buffer_Pool::Block_Buffer_Pool() : flags(0)
+{
+  const char* setting = getenv("OVERPASS_BLOCK_BUFFERS");
+  if (!setting)
+    return;
+
+  std::string value = setting;
+  std::string::size_type pos = 0;
+  while (pos <= value.size())
+  {
+    std::string::size_type end = value.find(',', pos);
+    if (end == std::string::npos)
+      end = value.size();
+    std::string token = value.substr(pos, end - pos);
+    if (token == "pool")
+      flags |= POOL;
+    else if (token == "huge")
+      flags |= POOL | HUGE_PAGES;
+    else if (token == "numa")
+      flags |= POOL | NUMA_LOCAL;
+    pos = end + 1;
+  }
+}
+
+
+uint64 Block_Buffer_Pool::mapped_size(uint64 size) const
+{
+  uint64 page_size = (flags & HUGE_PAGES) ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+  return (size + page_size - 1) / page_size * page_size;
+}
+
+
+uint64* Block_Buffer_Pool::map(uint64 size, int node) const
+{
+  void* ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  // Explicit huge pages are only available if the administrator has reserved some
+  if (flags & HUGE_PAGES)
+    ptr = mmap(0, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+#endif
+  if (ptr == MAP_FAILED)
+  {
+    ptr = mmap(0, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+      throw File_Error(errno, "-", "Block_Buffer_Pool::map");
+#ifdef MADV_HUGEPAGE
+    if (flags & HUGE_PAGES)
+      madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  }
+
+  // The pages are placed on their first touch, thus the policy must be set before any use
+  if (flags & NUMA_LOCAL)
+    prefer_numa_node(ptr, size, node);
+  return (uint64*)ptr;
+}
+
+
+uint64* Block_Buffer_Pool::allocate(uint64 size)
+{
+  if (size == 0)
+    return 0;
+  if (!flags)
+    return (uint64*)aligned_alloc(8, size);
+
+  uint64 mapped = mapped_size(size);
+  int node = (flags & NUMA_LOCAL) ? current_numa_node() : -1;
+
+  std::vector< Mapped_Buffer >::iterator best = free_buffers.end();
+  for (std::vector< Mapped_Buffer >::iterator it = free_buffers.begin(); it != free_buffers.end(); ++it)
+  {
+    if (it->size >= mapped && it->node == node && (best == free_buffers.end() || it->size < best->size))
+      best = it;
+  }
+
+  Mapped_Buffer buffer;
+  if (best != free_buffers.end())
+  {
+    buffer = *best;
+    *best = free_buffers.back();
+    free_buffers.pop_back();
+  }
+  else
+  {
+    buffer.ptr = map(mapped, node);
+    buffer.size = mapped;
+    buffer.node = node;
+  }
+  in_use[buffer.ptr] = buffer;
+  return buffer.ptr;
+}
+
+
+void Block_Buffer_Pool::release(uint64* ptr)
+{
+  if (!ptr)
+    return;
+  if (!flags)
+  {
+    free(ptr);
+    return;
+  }
+
+  std::map< uint64*, Mapped_Buffer >::iterator it = in_use.find(ptr);
+  if (it == in_use.end())
+    return;
+  Mapped_Buffer buffer = it->second;
+  in_use.erase(it);
+
+  if (free_buffers.size() < MAX_FREE_BUFFERS)
+    free_buffers.push_back(buffer);
+  else
+    munmap(ptr, buffer.size);
+}
@@ -26,6 +26,8 @@
 
 #include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -91,6 +93,145 @@ struct File_Blocks_Index_Base
 };
 
 
+/* Each index entry has room for a 32 bit summary of the objects in its block.
+ * Specializations for an object type condense each object into a value with of()
+ * and combine the values of all objects of a block with merge().
+ * A summary of zero is reserved for "unknown" and never allows to skip a block. */
+template< typename Object >
+struct Block_Summary
+{
+  static const bool enabled = false;
+  static uint32 of(const void* data) { return 0; }
+  static uint32 merge(uint32 lhs, uint32 rhs) { return 0; }
+};
+
+
+/* For files whose index carries the interesting information, the summary can instead
+ * be computed from the indices of the block. It is only used if Block_Summary of the object
+ * type is disabled. Same rules as for Block_Summary apply. */
+template< typename Index >
+struct Block_Index_Summary
+{
+  static const bool enabled = false;
+  static uint32 of(const void* data) { return 0; }
+  static uint32 merge(uint32 lhs, uint32 rhs) { return 0; }
+};
+
+
+/* Blocks of objects with an id can in addition carry a Bloom filter of the ids of their objects.
+ * Specializations enable it for an object type and extract the id of an object with id_of(). */
+template< typename Object >
+struct Block_Id_Bloom
+{
+  static const bool enabled = false;
+  static uint64 id_of(const void* data) { return 0; }
+};
+
+
+/* The id Bloom filters live in a side file of the data file with one slot per block position.
+ * A slot is only valid if it starts with MAGIC. Thus unwritten slots never allow to skip a block. */
+struct Id_Bloom_Slot
+{
+  static const uint32 MAGIC = 0x626c6f6f;
+  static const uint32 HEADER_SIZE = 8;
+  static const uint32 NUM_HASHES = 2;
+
+  // Appended to the name of the data file to get the name of the side file
+  static std::string file_suffix() { return ".bloom"; }
+
+  // A slot takes a quarter of a block position, hence the side file grows to a quarter
+  // of the size of the data file. This gives a few bits per node and more for larger objects.
+  static uint32 size_of(uint32 block_size) { return block_size / 4; }
+
+  // Spreads consecutive ids over all bits
+  static uint64 hash(uint64 id)
+  {
+    id = (id ^ (id>>30)) * 0xbf58476d1ce4e5b9ull;
+    id = (id ^ (id>>27)) * 0x94d049bb133111ebull;
+    return (id ^ (id>>31)) | 1;
+  }
+
+  static void clear(uint8* slot, uint32 slot_size)
+  {
+    memset(slot, 0, slot_size);
+    *(uint32*)slot = MAGIC;
+  }
+
+  static void add(uint8* slot, uint32 slot_size, uint64 id)
+  {
+    uint64 num_bits = (slot_size - HEADER_SIZE) * 8;
+    uint64 h = hash(id);
+    for (uint32 i = 0; i < NUM_HASHES; ++i)
+    {
+      uint64 bit = ((h & 0xffffffff) + i * (h>>32)) % num_bits;
+      slot[HEADER_SIZE + bit/8] |= (1u<<(bit%8));
+    }
+  }
+
+  // The caller must have checked that the slot is valid
+  static bool may_contain_hash(const uint8* slot, uint32 slot_size, uint64 h)
+  {
+    uint64 num_bits = (slot_size - HEADER_SIZE) * 8;
+    for (uint32 i = 0; i < NUM_HASHES; ++i)
+    {
+      uint64 bit = ((h & 0xffffffff) + i * (h>>32)) % num_bits;
+      if (!(slot[HEADER_SIZE + bit/8] & (1u<<(bit%8))))
+        return false;
+    }
+    return true;
+  }
+
+  static bool is_valid(const uint8* slot) { return *(const uint32*)slot == MAGIC; }
+};
+
+
+struct Block_Id_Filter;
+
+
+/* Lets a reader skip whole blocks based on their summary without reading them. */
+struct Block_Filter
+{
+  virtual ~Block_Filter() {}
+  virtual bool may_contain(uint32 summary) const = 0;
+
+  // Filters that also look at the id Bloom filters of the blocks return themselves here
+  virtual const Block_Id_Filter* id_filter() const { return 0; }
+};
+
+
+/* Lets a reader skip the blocks whose id Bloom filter rules out all the given ids.
+ * Each block costs a probe per id, hence callers should only use it for at most MAX_IDS ids. */
+struct Block_Id_Filter : Block_Filter
+{
+  static const uint32 MAX_IDS = 4096;
+
+  template< typename Iterator >
+  Block_Id_Filter(Iterator begin, Iterator end)
+  {
+    for (; begin != end; ++begin)
+      hashes.push_back(Id_Bloom_Slot::hash(begin->val()));
+  }
+
+  virtual bool may_contain(uint32 summary) const { return true; }
+  virtual const Block_Id_Filter* id_filter() const { return this; }
+
+  bool may_contain_any(const uint8* slot, uint32 slot_size) const
+  {
+    if (!Id_Bloom_Slot::is_valid(slot))
+      return true;
+    for (std::vector< uint64 >::const_iterator it = hashes.begin(); it != hashes.end(); ++it)
+    {
+      if (Id_Bloom_Slot::may_contain_hash(slot, slot_size, *it))
+        return true;
+    }
+    return false;
+  }
+
+private:
+  std::vector< uint64 > hashes;
+};
+
+
 struct File_Properties
 {
   virtual const std::string& get_file_name_trunk() const = 0;
@@ -236,6 +377,66 @@ public:
 };
 
 
+/** Process wide allocator for the block buffers of File_Blocks and Block_Backend iterators.
+ *
+ * It is controlled by the environment variable OVERPASS_BLOCK_BUFFERS, a comma separated list of
+ *   pool: keep released buffers for reuse by later File_Blocks and iterators of the process,
+ *   huge: back the buffers by explicit huge pages if reserved, else by transparent huge pages,
+ *   numa: place the buffers on the NUMA node of the CPU that requests them.
+ * Both huge and numa imply pool. Without the variable the buffers are plain heap memory. */
+class Block_Buffer_Pool
+{
+public:
+  enum { POOL = 1, HUGE_PAGES = 2, NUMA_LOCAL = 4 };
+
+  static Block_Buffer_Pool& instance();
+
+  uint64* allocate(uint64 size);
+  void release(uint64* ptr);
+
+  uint get_flags() const { return flags; }
+
+private:
+  struct Mapped_Buffer
+  {
+    uint64* ptr;
+    uint64 size;
+    int node;
+  };
+
+  // The pool is never destructed, such that File_Blocks in static objects can still release their buffers
+  Block_Buffer_Pool();
+
+  uint64 mapped_size(uint64 size) const;
+  uint64* map(uint64 size, int node) const;
+
+  uint flags;
+  std::map< uint64*, Mapped_Buffer > in_use;
+  std::vector< Mapped_Buffer > free_buffers;
+};
+
+
+/** RAII class for a buffer from the Block_Buffer_Pool. */
+class Block_Buffer
+{
+  Block_Buffer(const Block_Buffer&);
+  Block_Buffer& operator=(const Block_Buffer&);
+
+public:
+  explicit Block_Buffer(uint64 size) : ptr(Block_Buffer_Pool::instance().allocate(size)) {}
+  ~Block_Buffer() { Block_Buffer_Pool::instance().release(ptr); }
+
+  void swap(Block_Buffer& rhs)
+  {
+    uint64* temp = ptr;
+    ptr = rhs.ptr;
+    rhs.ptr = temp;
+  }
+
+  uint64* ptr;
+};
+
+
 inline bool file_exists(const std::string& filename)
 {
   return (access(filename.c_str(), F_OK) == 0);
@@ -359,6 +560,22 @@ inline void zero_padding(uint8* from, uint32 bytes)
 
 int& global_read_counter();
 
+
+struct Block_Read_Statistics
+{
+  Block_Read_Statistics() : blocks_read(0), blocks_decompressed(0), bytes_read(0), bytes_inflated(0) {}
+
+  uint64 blocks_read;
+  uint64 blocks_decompressed;
+  uint64 bytes_read;
+  uint64 bytes_inflated;
+};
+
+// The statistics are kept per data file name. They are only collected if enabled
+// because the bookkeeping costs a map lookup per block read.
+bool& block_read_statistics_enabled();
+std::map< std::string, Block_Read_Statistics >& global_block_read_statistics();
+
 enum Signal_Status { absent = 0, received, processed };
 Signal_Status& sigterm_status();
 void sigterm(int);
@@ -369,6 +586,8 @@ void millisleep(uint32 milliseconds);
 
 void copy_file(const std::string& source, const std::string& dest);
 void force_link_file(const std::string& source, const std::string& dest);
+// Replaces dest atomically by source, such that dest is never missing
+void move_file(const std::string& source, const std::string& dest);
 
 
 #endif